@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MemoryPool/ConcurrentAlloc.hpp"
+#include "benchUtil.h"
+
+/**
+ * 内存池与 glibc malloc 的分配/释放吞吐和常驻内存对比
+ * 每个 (分配器, 大小, 线程数) 组合在单独的子进程中运行，RSS 互不影响
+ * 每个线程反复申请 batch 个同样大小的对象、逐个写一个字节，再按申请的逆序全部释放；
+ * 内存池路径走 ThreadCache 的 BuffList，批量不足或过多时与 CentralCache 交换
+ * 每个组合输出一行 JSON
+*/
+
+struct Options {
+    std::vector<size_t> sizes = {16, 64, 256, 1024, 4096, 16384, 65536};
+    std::vector<int> threads = {1, 2, 4};
+    size_t ops = 2000000;       // 每线程申请次数
+    size_t batch = 1024;
+};
+
+// 返回 /proc/self/status 中的某一项，单位 kB
+static long procStatus(const char* key) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if(f == nullptr) {
+        return -1;
+    }
+    char line[256];
+    long value = -1;
+    size_t len = strlen(key);
+    while(fgets(line, sizeof(line), f)) {
+        if(strncmp(line, key, len) == 0 && line[len] == ':') {
+            value = atol(line + len + 1);
+            break;
+        }
+    }
+    fclose(f);
+    return value;
+}
+
+template<bool Pool>
+static void worker(size_t size, size_t ops, size_t batch) {
+    std::vector<void*> ptrs(batch);
+    for(size_t done = 0; done < ops; done += batch) {
+        for(size_t i = 0; i < batch; ++i) {
+            void* p = Pool ? ConcurrentAlloc(size) : malloc(size);
+            static_cast<char*>(p)[0] = static_cast<char>(i);
+            ptrs[i] = p;
+        }
+        for(size_t i = batch; i-- > 0;) {
+            if(Pool) {
+                ConcurrentFree(ptrs[i], size);
+            }
+            else {
+                free(ptrs[i]);
+            }
+        }
+    }
+}
+
+static void runOne(bool pool, size_t size, int threads, const Options& opt) {
+    long rssBefore = procStatus("VmRSS");
+    std::vector<std::thread> ts;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    uint64_t start = 0;
+    for(int i = 0; i < threads; ++i) {
+        ts.emplace_back([&] {
+            ready.fetch_add(1);
+            while(!go.load(std::memory_order_acquire)) {}
+            if(pool) {
+                worker<true>(size, opt.ops, opt.batch);
+            }
+            else {
+                worker<false>(size, opt.ops, opt.batch);
+            }
+        });
+    }
+    while(ready.load() < threads) {}
+    start = nowNs();
+    go.store(true, std::memory_order_release);
+    for(auto& t : ts) {
+        t.join();
+    }
+    uint64_t elapsed = nowNs() - start;
+    long rssAfter = procStatus("VmRSS");
+    long peak = procStatus("VmHWM");
+    // 一次申请加一次释放计为一次操作；worker 按整批执行，ops 不是 batch 的整数倍时向上取整
+    size_t perThread = (opt.ops + opt.batch - 1) / opt.batch * opt.batch;
+    double total = static_cast<double>(perThread) * threads;
+    printf("{\"bench\":\"alloc\",\"allocator\":\"%s\",\"size\":%zu,\"threads\":%d,\"batch\":%zu,\"ops\":%.0f,"
+           "\"mops\":%.2f,\"ns_per_op\":%.2f,\"rss_kb\":%ld,\"rss_growth_kb\":%ld,\"peak_rss_kb\":%ld}\n",
+           pool ? "pool" : "malloc", size, threads, opt.batch, total, total / elapsed * 1e3,
+           static_cast<double>(elapsed) * threads / total, rssAfter, rssAfter - rssBefore, peak);
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "s:t:n:b:h")) != -1) {
+        bool ok = true;
+        switch(c) {
+            case 's': ok = parseList(optarg, &opt.sizes); break;
+            case 't': ok = parseList(optarg, &opt.threads); break;
+            case 'n': opt.ops = strtoull(optarg, nullptr, 10); break;
+            case 'b': opt.batch = strtoull(optarg, nullptr, 10); break;
+            default: ok = false; break;
+        }
+        if(!ok || opt.batch == 0) {
+            fprintf(stderr, "usage: %s [-s sizes] [-t threads] [-n ops per thread] [-b batch]\n"
+                            "  lists are comma separated, e.g. -s 16,256,4096 -t 1,4\n", argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    for(size_t size : opt.sizes) {
+        for(int threads : opt.threads) {
+            for(int pool = 1; pool >= 0; --pool) {
+                pid_t pid = fork();
+                if(pid == 0) {
+                    runOne(pool == 1, size, threads, opt);
+                    _exit(0);
+                }
+                int status = 0;
+                waitpid(pid, &status, 0);
+            }
+        }
+    }
+    return 0;
+}
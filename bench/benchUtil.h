@@ -0,0 +1,47 @@
+#pragma once
+
+#include <time.h>
+#include <stdlib.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 各基准程序共用的计时与参数解析
+
+inline uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// 逗号分隔的列表，如 -a file,console
+inline bool parseList(const char* arg, std::vector<std::string>* out) {
+    out->clear();
+    std::string s(arg);
+    size_t start = 0;
+    while(start < s.size()) {
+        size_t comma = s.find(',', start);
+        if(comma == std::string::npos) comma = s.size();
+        out->push_back(s.substr(start, comma - start));
+        start = comma + 1;
+    }
+    return !out->empty();
+}
+
+// 逗号分隔的正整数列表，如 -t 1,4
+template<class T>
+bool parseList(const char* arg, std::vector<T>* out) {
+    std::vector<std::string> items;
+    if(!parseList(arg, &items)) {
+        return false;
+    }
+    out->clear();
+    for(const auto& item : items) {
+        long v = atol(item.c_str());
+        if(v <= 0) {
+            return false;
+        }
+        out->push_back(static_cast<T>(v));
+    }
+    return true;
+}
@@ -0,0 +1,423 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Pool/poolStats.hpp"
+#include "benchUtil.h"
+
+/**
+ * 回环压测工具：每个线程用一个 epoll 驱动自己的一组连接，连接数按线程均分
+ * 每个连接保持 pipeline 个请求在途（闭环），请求路径按权重从 -r 给出的组合中随机选取
+ * 延迟从请求写入发送缓冲到响应完整收到为止，预热期间完成的请求不计入
+ * 闭环压测在服务端变慢时会少发请求，测得的尾延迟偏乐观，比较版本间差异时需保持参数一致
+*/
+
+struct Target {
+    std::string path;
+    unsigned weight;
+};
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int threads = 1;
+    int connections = 16;
+    int pipeline = 1;
+    double duration = 10;
+    double warmup = 1;
+    bool keepAlive = true;
+    bool json = false;
+    std::vector<Target> mix;
+};
+
+struct ThreadResult {
+    uint64_t requests = 0;
+    uint64_t non2xx = 0;
+    uint64_t errors = 0;        // 连接失败、被对端重置或响应无法解析
+    uint64_t bytes = 0;
+    std::unique_ptr<LatencyHistogram> latency{new LatencyHistogram};
+};
+
+// 解析 "path[:weight],..."
+static bool parseMix(const char* arg, std::vector<Target>* mix) {
+    std::string s(arg);
+    size_t start = 0;
+    while(start < s.size()) {
+        size_t comma = s.find(',', start);
+        if(comma == std::string::npos) comma = s.size();
+        std::string item = s.substr(start, comma - start);
+        Target t;
+        t.weight = 1;
+        size_t colon = item.rfind(':');
+        if(colon != std::string::npos) {
+            t.weight = static_cast<unsigned>(atoi(item.c_str() + colon + 1));
+            item.resize(colon);
+        }
+        if(item.empty() || item[0] != '/' || t.weight == 0) {
+            return false;
+        }
+        t.path = item;
+        mix->push_back(t);
+        start = comma + 1;
+    }
+    return !mix->empty();
+}
+
+class Worker {
+public:
+    Worker(const Options& opt, const sockaddr_in& addr, int connections, uint64_t seed)
+        : opt_(opt), addr_(addr), conns_(connections), rng_(seed | 1) {
+        for(const Target& t : opt_.mix) {
+            totalWeight_ += t.weight;
+        }
+        pipeline_ = opt_.keepAlive ? opt_.pipeline : 1;
+    }
+
+    // 在 [start, start+warmup+duration) 内运行，结果写入 result_
+    void run(uint64_t start) {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        measureFrom_ = start + static_cast<uint64_t>(opt_.warmup * 1e9);
+        uint64_t end = measureFrom_ + static_cast<uint64_t>(opt_.duration * 1e9);
+        for(Conn& c : conns_) {
+            open(c);
+        }
+        epoll_event events[256];
+        while(nowNs() < end) {
+            int n = epoll_wait(epollFd_, events, 256, 100);
+            for(int i = 0; i < n; ++i) {
+                Conn* c = static_cast<Conn*>(events[i].data.ptr);
+                if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    onReadable(*c);
+                }
+                if(c->fd >= 0 && (events[i].events & EPOLLOUT)) {
+                    flush(*c);
+                }
+            }
+        }
+        for(Conn& c : conns_) {
+            if(c.fd >= 0) {
+                close(c.fd);
+            }
+        }
+        close(epollFd_);
+    }
+
+    ThreadResult& result() {
+        return result_;
+    }
+
+private:
+    struct Conn {
+        int fd = -1;
+        std::string out;
+        size_t outPos = 0;
+        std::string in;
+        size_t inPos = 0;
+        std::deque<uint64_t> sent;      // 在途请求的发送时间
+        bool wantWrite = false;
+    };
+
+    void open(Conn& c) {
+        c.out.clear();
+        c.outPos = 0;
+        c.in.clear();
+        c.inPos = 0;
+        c.sent.clear();
+        c.fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(c.fd < 0 || connect(c.fd, (const sockaddr*)&addr_, sizeof(addr_)) < 0) {
+            ++result_.errors;
+            if(c.fd >= 0) {
+                close(c.fd);
+                c.fd = -1;
+            }
+            return;
+        }
+        int one = 1;
+        setsockopt(c.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        fcntl(c.fd, F_SETFL, fcntl(c.fd, F_GETFL) | O_NONBLOCK);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = &c;
+        c.wantWrite = false;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, c.fd, &ev);
+        fill(c);
+    }
+
+    void reopen(Conn& c) {
+        if(c.fd >= 0) {
+            close(c.fd);
+            c.fd = -1;
+        }
+        open(c);
+    }
+
+    const std::string& pickPath() {
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 7;
+        rng_ ^= rng_ << 17;
+        uint64_t r = rng_ % totalWeight_;
+        for(const Target& t : opt_.mix) {
+            if(r < t.weight) {
+                return t.path;
+            }
+            r -= t.weight;
+        }
+        return opt_.mix.back().path;
+    }
+
+    // 补足在途请求到 pipeline 个，一次写出
+    void fill(Conn& c) {
+        while(static_cast<int>(c.sent.size()) < pipeline_) {
+            c.out += "GET ";
+            c.out += pickPath();
+            c.out += " HTTP/1.1\r\nHost: ";
+            c.out += opt_.host;
+            c.out += opt_.keepAlive ? "\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+            c.sent.push_back(nowNs());
+        }
+        flush(c);
+    }
+
+    void flush(Conn& c) {
+        while(c.outPos < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.outPos, c.out.size() - c.outPos, MSG_NOSIGNAL);
+            if(n < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                if(errno == EAGAIN) {
+                    break;
+                }
+                ++result_.errors;
+                reopen(c);
+                return;
+            }
+            c.outPos += n;
+        }
+        if(c.outPos == c.out.size()) {
+            c.out.clear();
+            c.outPos = 0;
+        }
+        bool want = !c.out.empty();
+        if(want != c.wantWrite) {
+            epoll_event ev{};
+            ev.events = want ? EPOLLIN | EPOLLOUT : static_cast<uint32_t>(EPOLLIN);
+            ev.data.ptr = &c;
+            epoll_ctl(epollFd_, EPOLL_CTL_MOD, c.fd, &ev);
+            c.wantWrite = want;
+        }
+    }
+
+    void onReadable(Conn& c) {
+        char buf[65536];
+        bool closed = false;
+        while(true) {
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if(n > 0) {
+                c.in.append(buf, n);
+                continue;
+            }
+            if(n < 0 && errno == EINTR) {
+                continue;
+            }
+            closed = n == 0 || errno != EAGAIN;
+            break;
+        }
+        int ret;
+        while((ret = parseOne(c)) > 0) {}
+        if(ret < 0) {
+            ++result_.errors;
+            reopen(c);
+            return;
+        }
+        if(c.inPos > 0 && c.inPos == c.in.size()) {
+            c.in.clear();
+            c.inPos = 0;
+        }
+        if(closed) {
+            // 短连接模式下对端关闭是正常结束；长连接下还有请求在途则记为错误
+            if(!c.sent.empty()) {
+                ++result_.errors;
+            }
+            reopen(c);
+            return;
+        }
+        if(!opt_.keepAlive && c.sent.empty()) {
+            reopen(c);
+            return;
+        }
+        fill(c);
+    }
+
+    // 解析一个完整响应，返回 1；不完整返回 0；格式错误返回 -1
+    int parseOne(Conn& c) {
+        if(c.sent.empty()) {
+            return c.inPos < c.in.size() ? -1 : 0;
+        }
+        size_t headEnd = c.in.find("\r\n\r\n", c.inPos);
+        if(headEnd == std::string::npos) {
+            return 0;
+        }
+        const char* p = c.in.data() + c.inPos;
+        if(headEnd - c.inPos < 12 || strncmp(p, "HTTP/1.", 7) != 0) {
+            return -1;
+        }
+        int status = atoi(p + 9);
+        size_t bodyLen = 0;
+        size_t line = c.in.find("\r\n", c.inPos) + 2;
+        while(line < headEnd) {
+            size_t next = c.in.find("\r\n", line);
+            if(next - line > 15 && strncasecmp(c.in.data() + line, "Content-Length:", 15) == 0) {
+                bodyLen = strtoull(c.in.data() + line + 15, nullptr, 10);
+            }
+            line = next + 2;
+        }
+        size_t total = headEnd + 4 - c.inPos + bodyLen;
+        if(c.in.size() - c.inPos < total) {
+            return 0;
+        }
+        c.inPos += total;
+        uint64_t now = nowNs();
+        uint64_t sentAt = c.sent.front();
+        c.sent.pop_front();
+        if(now >= measureFrom_) {
+            ++result_.requests;
+            result_.bytes += total;
+            if(status < 200 || status >= 300) {
+                ++result_.non2xx;
+            }
+            result_.latency->record(now - sentAt);
+        }
+        return 1;
+    }
+
+    const Options& opt_;
+    sockaddr_in addr_;
+    std::vector<Conn> conns_;
+    uint64_t rng_;
+    uint64_t totalWeight_ = 0;
+    int pipeline_;
+    int epollFd_ = -1;
+    uint64_t measureFrom_ = 0;
+    ThreadResult result_;
+};
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [-H host] [-p port] [-t threads] [-c connections] [-P pipeline] [-d seconds]\n"
+            "          [-w warmup] [-k 0|1] [-r path[:weight],...] [-j]\n"
+            "  -P  requests in flight per connection (keep-alive only)\n"
+            "  -k  0 opens a new connection for every request\n"
+            "  -r  weighted request mix, default /\n"
+            "  -j  print a single JSON line instead of text\n",
+            prog);
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "H:p:t:c:P:d:w:k:r:jh")) != -1) {
+        switch(c) {
+            case 'H': opt.host = optarg; break;
+            case 'p': opt.port = atoi(optarg); break;
+            case 't': opt.threads = atoi(optarg); break;
+            case 'c': opt.connections = atoi(optarg); break;
+            case 'P': opt.pipeline = atoi(optarg); break;
+            case 'd': opt.duration = atof(optarg); break;
+            case 'w': opt.warmup = atof(optarg); break;
+            case 'k': opt.keepAlive = atoi(optarg) != 0; break;
+            case 'r':
+                if(!parseMix(optarg, &opt.mix)) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'j': opt.json = true; break;
+            default:
+                usage(argv[0]);
+                return c == 'h' ? 0 : 1;
+        }
+    }
+    if(opt.mix.empty()) {
+        opt.mix.push_back(Target{"/", 1});
+    }
+    if(opt.threads < 1 || opt.connections < opt.threads || opt.pipeline < 1 || opt.duration <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opt.port);
+    if(inet_pton(AF_INET, opt.host.c_str(), &addr.sin_addr) != 1) {
+        struct hostent* he = gethostbyname(opt.host.c_str());
+        if(he == nullptr || he->h_addrtype != AF_INET) {
+            fprintf(stderr, "cannot resolve %s\n", opt.host.c_str());
+            return 1;
+        }
+        memcpy(&addr.sin_addr, he->h_addr_list[0], sizeof(addr.sin_addr));
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for(int i = 0; i < opt.threads; ++i) {
+        int n = opt.connections / opt.threads + (i < opt.connections % opt.threads ? 1 : 0);
+        workers.emplace_back(new Worker(opt, addr, n, nowNs() + i * 7919));
+    }
+    uint64_t start = nowNs();
+    std::vector<std::thread> threads;
+    for(auto& w : workers) {
+        threads.emplace_back([&w, start] { w->run(start); });
+    }
+    for(auto& t : threads) {
+        t.join();
+    }
+
+    uint64_t requests = 0, non2xx = 0, errors = 0, bytes = 0;
+    LatencyHistogram::Snapshot latency, part;
+    for(auto& w : workers) {
+        ThreadResult& r = w->result();
+        requests += r.requests;
+        non2xx += r.non2xx;
+        errors += r.errors;
+        bytes += r.bytes;
+        r.latency->snapshot(part);
+        latency.merge(part);
+    }
+    double rps = requests / opt.duration;
+    double mbps = bytes / opt.duration / (1024.0 * 1024.0);
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+
+    if(opt.json) {
+        printf("{\"threads\":%d,\"connections\":%d,\"pipeline\":%d,\"keepalive\":%s,\"duration\":%.1f,"
+               "\"requests\":%llu,\"rps\":%.1f,\"mbps\":%.2f,\"mean_us\":%.1f,\"p50_us\":%.1f,\"p90_us\":%.1f,"
+               "\"p99_us\":%.1f,\"p999_us\":%.1f,\"max_us\":%.1f,\"non2xx\":%llu,\"errors\":%llu}\n",
+               opt.threads, opt.connections, opt.pipeline, opt.keepAlive ? "true" : "false", opt.duration,
+               (unsigned long long)requests, rps, mbps, us(latency.mean()), us(latency.percentile(0.5)),
+               us(latency.percentile(0.9)), us(latency.percentile(0.99)), us(latency.percentile(0.999)),
+               us(latency.max), (unsigned long long)non2xx, (unsigned long long)errors);
+        return 0;
+    }
+    printf("%d threads, %d connections, pipeline %d, %s, %.1fs\n", opt.threads, opt.connections, opt.pipeline,
+           opt.keepAlive ? "keep-alive" : "close", opt.duration);
+    printf("  requests   %llu (%.1f req/s, %.2f MB/s)\n", (unsigned long long)requests, rps, mbps);
+    printf("  latency us mean %.1f  p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n", us(latency.mean()),
+           us(latency.percentile(0.5)), us(latency.percentile(0.9)), us(latency.percentile(0.99)),
+           us(latency.percentile(0.999)), us(latency.max));
+    printf("  non-2xx    %llu\n  errors     %llu\n", (unsigned long long)non2xx, (unsigned long long)errors);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Log/log.h"
+#include "Pool/poolStats.hpp"
+#include "benchUtil.h"
+
+/**
+ * LOG_INFO 单次调用延迟基准，每组 (输出器, 线程数) 输出一行 JSON
+ * 计时覆盖整条日志语句：构造 Temp、格式化消息、Temp 析构时经 Layout 格式化并由 Appender::output 加锁写出
+ * file 写到 -f 指定的文件（默认临时文件，结束后删除）；console 写 std::cout，测量期间 stdout 重定向到 /dev/null
+ * filtered 使用 ERROR 级别的日志器，测量被级别过滤掉的调用开销
+*/
+
+struct Options {
+    std::vector<std::string> appenders = {"file", "console", "filtered"};
+    std::vector<int> threads = {1, 2, 4};
+    size_t calls = 200000;      // 每线程调用次数
+    std::string file;
+};
+
+static const char* PATTERN = "%d [%p]  %t  {%F:%L}  <%c>  %e%n";
+
+static Lwy::Logger::ptr makeLogger(const std::string& appender, const std::string& file) {
+    Lwy::Appender::ptr out;
+    if(appender == "file") {
+        out.reset(new Lwy::FileAppender(file));
+    }
+    else {
+        out.reset(new Lwy::ConsoleAppender());
+    }
+    Lwy::LogLevel::Level level = appender == "filtered" ? Lwy::LogLevel::ERROR : Lwy::LogLevel::DEBUG;
+    return std::make_shared<Lwy::Logger>("bench", level, out, PATTERN);
+}
+
+static void runOne(const std::string& appender, int threads, const Options& opt) {
+    Lwy::Logger::ptr logger = makeLogger(appender, opt.file);
+    std::vector<std::unique_ptr<LatencyHistogram>> hists;
+    for(int i = 0; i < threads; ++i) {
+        hists.push_back(std::make_unique<LatencyHistogram>());
+    }
+
+    int savedStdout = -1;
+    if(appender == "console") {
+        std::cout.flush();
+        fflush(stdout);
+        savedStdout = dup(STDOUT_FILENO);
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+    }
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> ts;
+    for(int i = 0; i < threads; ++i) {
+        ts.emplace_back([&, i] {
+            LatencyHistogram& hist = *hists[i];
+            while(!go.load(std::memory_order_acquire)) {}
+            for(size_t j = 0; j < opt.calls; ++j) {
+                uint64_t begin = nowNs();
+                LOG_INFO(logger) << "GET /static/index.html 200 seq " << j << std::endl;
+                hist.record(nowNs() - begin);
+            }
+        });
+    }
+    uint64_t start = nowNs();
+    go.store(true, std::memory_order_release);
+    for(auto& t : ts) {
+        t.join();
+    }
+    uint64_t elapsed = nowNs() - start;
+
+    if(savedStdout >= 0) {
+        std::cout.flush();
+        fflush(stdout);
+        dup2(savedStdout, STDOUT_FILENO);
+        close(savedStdout);
+    }
+
+    LatencyHistogram::Snapshot total, tmp;
+    for(auto& h : hists) {
+        h->snapshot(tmp);
+        total.merge(tmp);
+    }
+    printf("{\"bench\":\"log\",\"appender\":\"%s\",\"threads\":%d,\"calls\":%lu,\"kcalls_per_s\":%.2f,"
+           "\"mean_ns\":%lu,\"p50_ns\":%lu,\"p99_ns\":%lu,\"p999_ns\":%lu,\"max_ns\":%lu}\n",
+           appender.c_str(), threads, static_cast<unsigned long>(total.count), total.count / (elapsed / 1e6),
+           static_cast<unsigned long>(total.mean()), static_cast<unsigned long>(total.percentile(0.5)),
+           static_cast<unsigned long>(total.percentile(0.99)), static_cast<unsigned long>(total.percentile(0.999)),
+           static_cast<unsigned long>(total.max));
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "a:t:n:f:h")) != -1) {
+        bool ok = true;
+        switch(c) {
+            case 'a':
+                ok = parseList(optarg, &opt.appenders);
+                for(auto& a : opt.appenders) {
+                    ok = ok && (a == "file" || a == "console" || a == "filtered");
+                }
+                break;
+            case 't':
+                ok = parseList(optarg, &opt.threads);
+                break;
+            case 'n': opt.calls = strtoull(optarg, nullptr, 10); break;
+            case 'f': opt.file = optarg; break;
+            default: ok = false; break;
+        }
+        if(!ok) {
+            fprintf(stderr, "usage: %s [-a file,console,filtered] [-t threads] [-n calls per thread] [-f file]\n"
+                            "  lists are comma separated, e.g. -t 1,4\n", argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    bool tempFile = opt.file.empty();
+    if(tempFile) {
+        char path[] = "/tmp/log_bench.XXXXXX";
+        int fd = mkstemp(path);
+        if(fd < 0) {
+            perror("mkstemp");
+            return 1;
+        }
+        close(fd);
+        opt.file = path;
+    }
+    for(auto& appender : opt.appenders) {
+        for(int n : opt.threads) {
+            runOne(appender, n, opt);
+        }
+    }
+    if(tempFile) {
+        unlink(opt.file.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <latch>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Pool/threadPool.hpp"
+#include "benchUtil.h"
+
+/**
+ * ThreadPool 吞吐基准，每组配置输出一行 JSON
+ * produce：P 个生产者线程并发 addTask 空任务，统计从第一次提交到最后一个任务执行完的吞吐，
+ *          以及线程池自身统计的排队等待时间分位数，主要反映任务队列锁的竞争
+ * fanout：单个提交者每轮提交 M 个任务并等待全部完成（类似一次请求拆成多个子任务），
+ *         统计每轮的完成时间分位数，主要反映唤醒延迟
+ * 每组配置使用新的固定大小线程池，统计互不影响
+*/
+
+struct Options {
+    std::vector<int> workers = {1, 2, 4};
+    std::vector<int> producers = {1, 4};
+    size_t tasks = 1000000;     // produce 每组提交的任务总数
+    size_t fanout = 64;         // fanout 每轮任务数
+    size_t rounds = 20000;      // fanout 轮数
+    std::string mode = "all";
+};
+
+static void benchProduce(int workers, int producers, size_t tasks) {
+    ThreadPool pool(workers);
+    std::atomic<size_t> done{0};
+    size_t perProducer = tasks / producers;
+    size_t total = perProducer * producers;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> ts;
+    for(int i = 0; i < producers; ++i) {
+        ts.emplace_back([&] {
+            while(!go.load(std::memory_order_acquire)) {}
+            for(size_t j = 0; j < perProducer; ++j) {
+                pool.addTask([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+            }
+        });
+    }
+    uint64_t start = nowNs();
+    go.store(true, std::memory_order_release);
+    for(auto& t : ts) {
+        t.join();
+    }
+    uint64_t submitted = nowNs();
+    while(done.load(std::memory_order_relaxed) < total) {
+        std::this_thread::yield();
+    }
+    uint64_t elapsed = nowNs() - start;
+    PoolStats st = pool.stats();
+    printf("{\"bench\":\"pool_produce\",\"workers\":%d,\"producers\":%d,\"tasks\":%zu,"
+           "\"submit_ms\":%.2f,\"total_ms\":%.2f,\"mtasks_per_s\":%.3f,\"queue_max\":%zu,"
+           "\"wait_p50_us\":%.2f,\"wait_p99_us\":%.2f,\"wait_max_us\":%.2f,\"idle_waits\":%lu}\n",
+           workers, producers, total, (submitted - start) / 1e6, elapsed / 1e6,
+           total / (elapsed / 1e3) , st.queueHighWater,
+           st.wait.percentile(0.5) / 1e3, st.wait.percentile(0.99) / 1e3, st.wait.max / 1e3,
+           static_cast<unsigned long>(st.idleWaits));
+    fflush(stdout);
+}
+
+static void benchFanout(int workers, size_t fanout, size_t rounds) {
+    ThreadPool pool(workers);
+    auto hist = std::make_unique<LatencyHistogram>();
+    uint64_t start = nowNs();
+    for(size_t r = 0; r < rounds; ++r) {
+        uint64_t begin = nowNs();
+        std::latch latch(static_cast<std::ptrdiff_t>(fanout));
+        for(size_t i = 0; i < fanout; ++i) {
+            pool.addTask([&latch] { latch.count_down(); });
+        }
+        latch.wait();
+        hist->record(nowNs() - begin);
+    }
+    uint64_t elapsed = nowNs() - start;
+    LatencyHistogram::Snapshot snap;
+    hist->snapshot(snap);
+    printf("{\"bench\":\"pool_fanout\",\"workers\":%d,\"fanout\":%zu,\"rounds\":%zu,"
+           "\"mtasks_per_s\":%.3f,\"round_mean_us\":%.2f,\"round_p50_us\":%.2f,"
+           "\"round_p99_us\":%.2f,\"round_p999_us\":%.2f,\"round_max_us\":%.2f}\n",
+           workers, fanout, rounds, fanout * rounds / (elapsed / 1e3),
+           snap.mean() / 1e3, snap.percentile(0.5) / 1e3, snap.percentile(0.99) / 1e3,
+           snap.percentile(0.999) / 1e3, snap.max / 1e3);
+    fflush(stdout);
+}
+
+int main(int argc, char* argv[]) {
+    Options opt;
+    int c;
+    while((c = getopt(argc, argv, "w:p:n:f:r:m:h")) != -1) {
+        bool ok = true;
+        switch(c) {
+            case 'w': ok = parseList(optarg, &opt.workers); break;
+            case 'p': ok = parseList(optarg, &opt.producers); break;
+            case 'n': opt.tasks = strtoull(optarg, nullptr, 10); break;
+            case 'f': opt.fanout = strtoull(optarg, nullptr, 10); break;
+            case 'r': opt.rounds = strtoull(optarg, nullptr, 10); break;
+            case 'm':
+                opt.mode = optarg;
+                ok = opt.mode == "all" || opt.mode == "produce" || opt.mode == "fanout";
+                break;
+            default: ok = false; break;
+        }
+        if(!ok || opt.fanout == 0) {
+            fprintf(stderr, "usage: %s [-m all|produce|fanout] [-w workers] [-p producers] [-n tasks]"
+                            " [-f fanout] [-r rounds]\n"
+                            "  lists are comma separated, e.g. -w 1,2,4\n", argv[0]);
+            return c == 'h' ? 0 : 1;
+        }
+    }
+    // 线程池的创建日志写到 log.txt，这里只保留错误
+    INS()->setLevel("error");
+    for(int workers : opt.workers) {
+        if(opt.mode != "fanout") {
+            for(int producers : opt.producers) {
+                benchProduce(workers, producers, opt.tasks);
+            }
+        }
+        if(opt.mode != "produce") {
+            benchFanout(workers, opt.fanout, opt.rounds);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#!/usr/bin/env bash
+# 端到端基准：分别以内存池和 malloc 构建，按 线程池大小 x 分配器 x 日志模式 组合启动服务器并用 loadgen 压测
+# 每组结果输出一行 JSON（loadgen -j 的字段加上服务器配置），追加到 $OUT
+#
+# 可通过环境变量调整：
+#   THREADS="1 2 4"        服务器线程池大小
+#   ALLOCS="pool malloc"   分配器
+#   LOGS="quiet access"    quiet 只记录错误；access 每个请求写一行 INFO 访问日志
+#   DURATION=10 WARMUP=2 CONNS=64 PIPELINE=1 LOADGEN_THREADS=2 MIX="/"
+#   LOOPS=0 BACKEND=epoll  LOOPS>0 时使用多 Reactor 模式
+#   PORT=18080 OUT=bench_output.txt BUILD_ROOT=_bench_build
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+THREADS="${THREADS:-1 2 4}"
+ALLOCS="${ALLOCS:-pool malloc}"
+LOGS="${LOGS:-quiet access}"
+DURATION="${DURATION:-10}"
+WARMUP="${WARMUP:-2}"
+CONNS="${CONNS:-64}"
+PIPELINE="${PIPELINE:-1}"
+LOADGEN_THREADS="${LOADGEN_THREADS:-2}"
+MIX="${MIX:-/}"
+LOOPS="${LOOPS:-0}"
+BACKEND="${BACKEND:-epoll}"
+PORT="${PORT:-18080}"
+OUT="${OUT:-$ROOT/bench_output.txt}"
+BUILD_ROOT="${BUILD_ROOT:-$ROOT/_bench_build}"
+
+build() {
+    local alloc="$1" dir="$BUILD_ROOT/$1" malloc=OFF
+    [ "$alloc" = malloc ] && malloc=ON
+    cmake -S "$ROOT" -B "$dir" -DCMAKE_BUILD_TYPE=Release -DWEBSERVER_USE_MALLOC="$malloc" ${CMAKE_ARGS:-} > /dev/null
+    cmake --build "$dir" -j"$(nproc)" > /dev/null
+}
+
+wait_port() {
+    for _ in $(seq 50); do
+        (exec 3<>"/dev/tcp/127.0.0.1/$PORT") 2> /dev/null && return 0
+        sleep 0.1
+    done
+    return 1
+}
+
+for alloc in $ALLOCS; do
+    echo "building $alloc" >&2
+    build "$alloc"
+done
+
+# 服务器的 log.txt 写在临时目录里，不污染仓库
+WORK="$(mktemp -d)"
+SERVER_PID=
+cleanup() {
+    [ -n "$SERVER_PID" ] && kill -TERM "$SERVER_PID" 2> /dev/null || true
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+
+for alloc in $ALLOCS; do
+    bin="$BUILD_ROOT/$alloc"
+    for threads in $THREADS; do
+        for log in $LOGS; do
+            case "$log" in
+                quiet) log_args=(-L error) ;;
+                access) log_args=(-L info -a) ;;
+                *) echo "unknown log mode $log" >&2; exit 1 ;;
+            esac
+            (cd "$WORK" && exec "$bin/webserver" -p "$PORT" -t "$threads" -l "$LOOPS" -b "$BACKEND" "${log_args[@]}") &
+            SERVER_PID=$!
+            if ! wait_port; then
+                echo "server did not start: alloc=$alloc threads=$threads log=$log" >&2
+                exit 1
+            fi
+            result="$("$bin/loadgen" -p "$PORT" -t "$LOADGEN_THREADS" -c "$CONNS" -P "$PIPELINE" \
+                -d "$DURATION" -w "$WARMUP" -r "$MIX" -j)"
+            kill -TERM "$SERVER_PID" 2> /dev/null || true
+            wait "$SERVER_PID" 2> /dev/null || true
+            SERVER_PID=
+            rm -f "$WORK/log.txt"
+            line="{\"alloc\":\"$alloc\",\"server_threads\":$threads,\"log\":\"$log\",\"loops\":$LOOPS,\"backend\":\"$BACKEND\",${result#\{}"
+            echo "$line" | tee -a "$OUT"
+        done
+    done
+done
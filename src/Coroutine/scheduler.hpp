@@ -0,0 +1,206 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include "task.hpp"
+#include "../Pool/threadPool.hpp"
+#include "../Pool/timerWheel.hpp"
+#include "../Pool/blockingExecutor.hpp"
+
+/**
+ * 协程调度器：协程的每次恢复都投递到 ThreadPool 的工作线程上执行
+ * 提供三种等待：
+ *   co_await sched.yield()              让出当前线程，重新排队
+ *   co_await sched.sleep(100ms)         由时间轮到期后恢复
+ *   co_await sched.waitFd(fd, EPOLLIN)  fd 就绪后恢复，返回就绪事件
+ *   co_await sched.blocking(fn)         fn 在阻塞执行器上运行，完成后回到线程池恢复，返回 fn 的结果
+ * 同一个 fd 同一时刻只能有一个协程在等待
+ * 调度器析构时仍挂起的协程不会再被恢复，调用者需保证先结束它们
+*/
+class CoScheduler {
+public:
+    explicit CoScheduler(ThreadPool& pool, BlockingExecutor* blocking = nullptr,
+                         std::chrono::milliseconds tick = std::chrono::milliseconds(1))
+        : pool_(pool), blocking_(blocking), wheel_(&pool, tick) {
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        assert(epollFd_ >= 0 && wakeFd_ >= 0);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.ptr = nullptr;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+        wheel_.start();
+        poller_ = std::thread([this] { pollLoop(); });
+    }
+
+    ~CoScheduler() {
+        uint64_t one = 1;
+        ssize_t n = write(wakeFd_, &one, sizeof(one));
+        (void)n;
+        poller_.join();
+        wheel_.stop();
+        close(wakeFd_);
+        close(epollFd_);
+    }
+
+    void spawn(Task<void> task) {
+        std::coroutine_handle<> h = runDetached(std::move(task)).handle;
+        pool_.addTask([h] { h.resume(); });
+    }
+
+    struct YieldAwaiter {
+        ThreadPool& pool;
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            pool.addTask([h] { h.resume(); });
+        }
+        void await_resume() noexcept {}
+    };
+
+    struct SleepAwaiter {
+        TimerWheel& wheel;
+        std::chrono::milliseconds delay;
+        bool await_ready() noexcept { return delay.count() <= 0; }
+        void await_suspend(std::coroutine_handle<> h) {
+            // 时间轮以本调度器的线程池构造，回调已在工作线程上执行
+            wheel.schedule(delay, [h] { h.resume(); });
+        }
+        void await_resume() noexcept {}
+    };
+
+    struct FdAwaiter {
+        CoScheduler& sched;
+        int fd;
+        uint32_t events;
+        uint32_t revents = 0;
+        std::coroutine_handle<> h{};
+
+        bool await_ready() noexcept { return false; }
+        // 注册失败时不挂起，直接以 EPOLLERR 返回
+        bool await_suspend(std::coroutine_handle<> caller) {
+            h = caller;
+            return sched.watch(this);
+        }
+        uint32_t await_resume() noexcept { return revents; }
+    };
+
+    template<class F>
+    struct BlockingAwaiter {
+        typedef typename std::invoke_result<F&>::type R;
+        typedef typename std::conditional<std::is_void<R>::value, char, R>::type Value;
+
+        CoScheduler& sched;
+        F fn;
+        std::optional<Value> value{};
+        std::exception_ptr exception{};
+
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            sched.blocking_->addTask([this, h] {
+                try {
+                    if constexpr (std::is_void<R>::value) {
+                        fn();
+                        value.emplace(0);
+                    }
+                    else {
+                        value.emplace(fn());
+                    }
+                }
+                catch(...) {
+                    exception = std::current_exception();
+                }
+                sched.pool_.addTask([h] { h.resume(); });
+            });
+        }
+        R await_resume() {
+            if(exception) {
+                std::rethrow_exception(exception);
+            }
+            if constexpr (!std::is_void<R>::value) {
+                return std::move(*value);
+            }
+        }
+    };
+
+    // 需要在构造时提供 BlockingExecutor
+    template<class F>
+    BlockingAwaiter<typename std::decay<F>::type> blocking(F&& fn) {
+        assert(blocking_ != nullptr);
+        return BlockingAwaiter<typename std::decay<F>::type>{*this, std::forward<F>(fn)};
+    }
+
+    YieldAwaiter yield() {
+        return YieldAwaiter{pool_};
+    }
+
+    SleepAwaiter sleep(std::chrono::milliseconds delay) {
+        return SleepAwaiter{wheel_, delay};
+    }
+
+    FdAwaiter waitFd(int fd, uint32_t events) {
+        return FdAwaiter{*this, fd, events};
+    }
+
+    ThreadPool& pool() {
+        return pool_;
+    }
+
+    TimerWheel& timers() {
+        return wheel_;
+    }
+
+private:
+    static DetachedTask runDetached(Task<void> task) {
+        co_await std::move(task);
+    }
+
+    // 以 EPOLLONESHOT 注册，触发一次后自动失效，下次等待用 MOD 重新激活
+    bool watch(FdAwaiter* aw) {
+        epoll_event ev{};
+        ev.events = aw->events | EPOLLONESHOT;
+        ev.data.ptr = aw;
+        if(epoll_ctl(epollFd_, EPOLL_CTL_MOD, aw->fd, &ev) == 0) {
+            return true;
+        }
+        if(errno == ENOENT && epoll_ctl(epollFd_, EPOLL_CTL_ADD, aw->fd, &ev) == 0) {
+            return true;
+        }
+        LOG_ERROR(INS()) << "waitFd on fd " << aw->fd << " failed, errno " << errno << std::endl;
+        aw->revents = EPOLLERR;
+        return false;
+    }
+
+    void pollLoop() {
+        epoll_event events[64];
+        while(true) {
+            int n = epoll_wait(epollFd_, events, 64, -1);
+            if(n < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR(INS()) << "CoScheduler epoll_wait failed, errno " << errno << std::endl;
+                return;
+            }
+            for(int i = 0; i < n; ++i) {
+                if(events[i].data.ptr == nullptr) {
+                    return;
+                }
+                FdAwaiter* aw = static_cast<FdAwaiter*>(events[i].data.ptr);
+                aw->revents = events[i].events;
+                std::coroutine_handle<> h = aw->h;
+                pool_.addTask([h] { h.resume(); });
+            }
+        }
+    }
+
+    ThreadPool& pool_;
+    BlockingExecutor* blocking_;
+    TimerWheel wheel_;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    std::thread poller_;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <utility>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <coroutine>
+#include "../Log/log.h"
+#include "../MemoryPool/ConcurrentAlloc.hpp"
+
+/**
+ * C++20 协程任务类型 Task<T>
+ * 惰性启动：创建后不执行，被 co_await 或交给 CoScheduler::spawn 时才开始运行
+ * 结束时通过对称转移直接恢复等待者，不经过线程池，避免多一次调度
+ * 协程帧经由内存池分配
+*/
+
+// 协程帧从内存池分配，释放时编译器会传回帧大小
+struct PoolFrame {
+    static void* operator new(size_t size) {
+        return ConcurrentAlloc(size);
+    }
+    static void operator delete(void* ptr, size_t size) {
+        ConcurrentFree(ptr, size);
+    }
+};
+
+template<typename T = void>
+class Task;
+
+struct TaskPromiseBase : PoolFrame {
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template<typename P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+            std::coroutine_handle<> next = h.promise().continuation_;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception_ = std::current_exception(); }
+
+    std::coroutine_handle<> continuation_;
+    std::exception_ptr exception_;
+};
+
+template<typename T>
+struct TaskPromise : TaskPromiseBase {
+    Task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U&& value) {
+        value_.emplace(std::forward<U>(value));
+    }
+
+    T result() {
+        if(exception_) {
+            std::rethrow_exception(exception_);
+        }
+        return std::move(*value_);
+    }
+
+    std::optional<T> value_;
+};
+
+template<>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+
+    void return_void() {}
+
+    void result() {
+        if(exception_) {
+            std::rethrow_exception(exception_);
+        }
+    }
+};
+
+template<typename T>
+class Task {
+public:
+    typedef TaskPromise<T> promise_type;
+    typedef std::coroutine_handle<promise_type> handle_type;
+
+    Task() = default;
+    explicit Task(handle_type h) : handle_(h) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if(this != &other) {
+            if(handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if(handle_) {
+            handle_.destroy();
+        }
+    }
+
+    // 空任务（默认构造或已被移走）视为已完成，恢复时抛 std::logic_error，不解引用空句柄
+    struct Awaiter {
+        handle_type h;
+        bool await_ready() noexcept { return !h || h.done(); }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+            h.promise().continuation_ = caller;
+            return h;
+        }
+        T await_resume() {
+            if(!h) {
+                throw std::logic_error("co_await on an empty Task");
+            }
+            return h.promise().result();
+        }
+    };
+
+    Awaiter operator co_await() && noexcept {
+        return Awaiter{handle_};
+    }
+
+private:
+    handle_type handle_;
+};
+
+template<typename T>
+inline Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// 脱离调用者独立运行的协程，结束后自行销毁帧，异常只记录日志
+struct DetachedTask {
+    struct promise_type : PoolFrame {
+        DetachedTask get_return_object() {
+            return DetachedTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() {
+            try {
+                throw;
+            }
+            catch(const std::exception& e) {
+                LOG_ERROR(INS()) << "detached coroutine exited with exception: " << e.what() << std::endl;
+            }
+            catch(...) {
+                LOG_ERROR(INS()) << "detached coroutine exited with unknown exception" << std::endl;
+            }
+        }
+    };
+
+    std::coroutine_handle<> handle;
+};
@@ -0,0 +1,292 @@
+#include "httpParser.h"
+#include <strings.h>
+#include "simdScan.h"
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+
+static std::string_view trim(const char* begin, const char* end) {
+    while(begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while(end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    return std::string_view(begin, end - begin);
+}
+
+// 值中是否包含逗号分隔的 token，如 Connection: keep-alive, Upgrade
+static bool hasToken(std::string_view value, std::string_view token) {
+    size_t start = 0;
+    while(start <= value.size()) {
+        size_t comma = value.find(',', start);
+        if(comma == std::string_view::npos) comma = value.size();
+        std::string_view item = trim(value.data() + start, value.data() + comma);
+        if(equalsIgnoreCase(item, token)) {
+            return true;
+        }
+        start = comma + 1;
+    }
+    return false;
+}
+
+// Transfer-Encoding 的值以 chunked 结尾，且前面的编码中没有 chunked
+static bool isFinalChunked(std::string_view value) {
+    size_t comma = value.rfind(',');
+    if(comma == std::string_view::npos) {
+        return equalsIgnoreCase(trim(value.data(), value.data() + value.size()), "chunked");
+    }
+    std::string_view last = trim(value.data() + comma + 1, value.data() + value.size());
+    return equalsIgnoreCase(last, "chunked") && !hasToken(value.substr(0, comma), "chunked");
+}
+
+static int hexValue(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for(const auto& h : headers) {
+        if(equalsIgnoreCase(h.name, name)) {
+            return h.value;
+        }
+    }
+    return std::string_view();
+}
+
+HttpParser::HttpParser() {
+    request_.headers.reserve(16);
+}
+
+void HttpParser::reset() {
+    state_ = HEADERS;
+    base_ = nullptr;
+    skip_ = scanPos_ = headLen_ = contentLength_ = chunkRemain_ = pos_ = trailerStart_ = consumed_ = 0;
+    chunkBody_.clear();
+    request_.headers.clear();
+    request_.body = std::string_view();
+}
+
+// 缓冲被搬移时，所有指向旧缓冲的 string_view 平移到新地址
+void HttpParser::rebase(const char* data) {
+    if(base_ == nullptr || base_ == data) {
+        base_ = data;
+        return;
+    }
+    auto move = [this, data](std::string_view& v) {
+        if(v.data() != nullptr && v.data() != chunkBody_.data()) {
+            v = std::string_view(data + (v.data() - base_), v.size());
+        }
+    };
+    move(request_.method);
+    move(request_.target);
+    move(request_.path);
+    move(request_.query);
+    for(auto& h : request_.headers) {
+        move(h.name);
+        move(h.value);
+    }
+    move(request_.body);
+    base_ = data;
+}
+
+HttpParser::Result HttpParser::parse(const char* data, size_t len) {
+    if(state_ == HEADERS) {
+        // 请求行之前允许出现空行，算作本请求的一部分由调用者一并消费，计入请求头长度上限；
+        // 从上次跳过的位置继续，不重复扫描
+        while(skip_ + 1 < len && data[skip_] == '\r' && data[skip_ + 1] == '\n') {
+            skip_ += 2;
+        }
+        if(skip_ > kMaxHeaderBytes) {
+            return ERROR;
+        }
+    }
+    data += skip_;
+    len -= skip_;
+    rebase(data);
+
+    if(state_ == HEADERS) {
+        const char* from = data + (scanPos_ > 3 ? scanPos_ - 3 : 0);
+        const char* end = findHeaderEnd(from, data + len);
+        if(end == nullptr) {
+            scanPos_ = len;
+            return skip_ + len > kMaxHeaderBytes ? ERROR : INCOMPLETE;
+        }
+        headLen_ = end + 4 - data;
+        if(skip_ + headLen_ > kMaxHeaderBytes || !parseHead(data, end + 2)) {
+            return ERROR;
+        }
+        if(state_ == HEADERS) {
+            consumed_ = skip_ + headLen_;
+            return COMPLETE;
+        }
+    }
+    if(state_ == BODY) {
+        if(len - headLen_ < contentLength_) {
+            return INCOMPLETE;
+        }
+        request_.body = std::string_view(data + headLen_, contentLength_);
+        consumed_ = skip_ + headLen_ + contentLength_;
+        return COMPLETE;
+    }
+    Result r = parseChunked(data, len);
+    if(r == COMPLETE) {
+        consumed_ = skip_ + pos_;
+    }
+    return r;
+}
+
+// [data, end) 为请求行加全部请求头，每行以 \r\n 结尾；行内出现孤立的 \r 视为错误，不能截断该行
+bool HttpParser::parseHead(const char* data, const char* end) {
+    HttpRequest& req = request_;
+    const char* eol = findChar(data, end, '\r');
+    if(eol + 1 >= end || eol[1] != '\n') return false;
+    const char* sp1 = static_cast<const char*>(memchr(data, ' ', eol - data));
+    if(sp1 == nullptr) return false;
+    const char* sp2 = static_cast<const char*>(memchr(sp1 + 1, ' ', eol - sp1 - 1));
+    if(sp2 == nullptr || sp1 == data || sp2 == sp1 + 1) return false;
+    req.method = std::string_view(data, sp1 - data);
+    req.target = std::string_view(sp1 + 1, sp2 - sp1 - 1);
+    size_t q = req.target.find('?');
+    req.path = req.target.substr(0, q);
+    req.query = q == std::string_view::npos ? std::string_view() : req.target.substr(q + 1);
+
+    std::string_view version(sp2 + 1, eol - sp2 - 1);
+    if(version.size() != 8 || version.substr(0, 7) != "HTTP/1." || version[7] < '0' || version[7] > '9') {
+        return false;
+    }
+    req.versionMinor = version[7] - '0';
+
+    bool chunked = false;
+    bool hasLength = false;
+    std::string_view connection;
+    const char* line = eol + 2;
+    while(line < end) {
+        eol = findChar(line, end, '\r');
+        if(eol + 1 >= end || eol[1] != '\n') {
+            return false;
+        }
+        const char* colon = static_cast<const char*>(memchr(line, ':', eol - line));
+        if(colon == nullptr || colon == line || req.headers.size() >= kMaxHeaders) {
+            return false;
+        }
+        HttpRequest::Header h;
+        h.name = std::string_view(line, colon - line);
+        if(h.name.back() == ' ' || h.name.back() == '\t') {
+            return false;
+        }
+        h.value = trim(colon + 1, eol);
+        req.headers.push_back(h);
+
+        if(equalsIgnoreCase(h.name, "Content-Length")) {
+            size_t n = 0;
+            if(h.value.empty() || hasLength) return false;
+            for(char c : h.value) {
+                if(c < '0' || c > '9') return false;
+                n = n * 10 + (c - '0');
+                if(n > kMaxBodyBytes) return false;
+            }
+            contentLength_ = n;
+            hasLength = true;
+        }
+        else if(equalsIgnoreCase(h.name, "Transfer-Encoding")) {
+            // 多个 Transfer-Encoding 头按顺序拼成一个列表，chunked 必须是最后一个编码且只出现一次，
+            // 否则无法确定请求体的边界
+            if(chunked || !isFinalChunked(h.value)) {
+                return false;
+            }
+            chunked = true;
+        }
+        else if(equalsIgnoreCase(h.name, "Connection")) {
+            connection = h.value;
+        }
+        line = eol + 2;
+    }
+
+    // 同时带 Content-Length 与 chunked 时请求体边界有歧义，可被用来夹带请求，直接拒绝
+    if(chunked && hasLength) {
+        return false;
+    }
+
+    if(req.versionMinor >= 1) {
+        req.keepAlive = !hasToken(connection, "close");
+    }
+    else {
+        req.keepAlive = hasToken(connection, "keep-alive");
+    }
+
+    if(chunked) {
+        state_ = CHUNK_SIZE;
+        pos_ = headLen_;
+    }
+    else if(hasLength && contentLength_ > 0) {
+        state_ = BODY;
+    }
+    return true;
+}
+
+// 行长度与 trailer 总长都有上限，没有收到行尾时也按已收到的字节数检查，避免无限缓存
+HttpParser::Result HttpParser::parseChunked(const char* data, size_t len) {
+    while(true) {
+        if(state_ == CHUNK_SIZE) {
+            const char* p = data + pos_;
+            const char* eol = findChar(p, data + len, '\r');
+            if(static_cast<size_t>(eol - p) > kMaxChunkLineBytes) {
+                return ERROR;
+            }
+            if(eol + 1 >= data + len) {
+                return INCOMPLETE;
+            }
+            if(eol[1] != '\n') return ERROR;
+            // chunk-size 是连续的十六进制数字，之后只能是可选空白加 ;扩展
+            size_t size = 0;
+            const char* c = p;
+            for(int v; c < eol && (v = hexValue(*c)) >= 0; ++c) {
+                size = size * 16 + v;
+                if(size > kMaxBodyBytes) return ERROR;
+            }
+            if(c == p) return ERROR;
+            while(c < eol && (*c == ' ' || *c == '\t')) ++c;
+            if(c < eol && *c != ';') return ERROR;
+            pos_ = eol + 2 - data;
+            chunkRemain_ = size;
+            if(size == 0) {
+                state_ = TRAILERS;
+                trailerStart_ = pos_;
+            }
+            else {
+                state_ = CHUNK_DATA;
+            }
+        }
+        else if(state_ == CHUNK_DATA) {
+            if(len - pos_ < chunkRemain_ + 2) {
+                return INCOMPLETE;
+            }
+            if(data[pos_ + chunkRemain_] != '\r' || data[pos_ + chunkRemain_ + 1] != '\n') {
+                return ERROR;
+            }
+            if(chunkBody_.size() + chunkRemain_ > kMaxBodyBytes) {
+                return ERROR;
+            }
+            chunkBody_.append(data + pos_, chunkRemain_);
+            pos_ += chunkRemain_ + 2;
+            state_ = CHUNK_SIZE;
+        }
+        else {
+            // 跳过 trailer 字段，直到空行
+            const char* p = data + pos_;
+            const char* eol = findChar(p, data + len, '\r');
+            if(static_cast<size_t>(eol - (data + trailerStart_)) > kMaxTrailerBytes) {
+                return ERROR;
+            }
+            if(eol + 1 >= data + len) {
+                return INCOMPLETE;
+            }
+            if(eol[1] != '\n') return ERROR;
+            pos_ = eol + 2 - data;
+            if(eol == p) {
+                request_.body = std::string_view(chunkBody_);
+                return COMPLETE;
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <string_view>
+
+// 一个已解析的请求，字段都是指向连接读缓冲的 string_view，在请求被消费前有效
+struct HttpRequest {
+    struct Header {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    std::string_view method;
+    std::string_view target;        // 请求行中的原始目标，含查询串
+    std::string_view path;          // 去掉查询串的路径
+    std::string_view query;
+    int versionMinor = 1;           // HTTP/1.x 中的 x
+    std::vector<Header> headers;
+    std::string_view body;          // chunked 请求体指向解析器内部拼接后的缓冲
+    bool keepAlive = true;
+
+    // 按名称查找请求头，忽略大小写，不存在返回空
+    std::string_view header(std::string_view name) const;
+};
+
+/**
+ * 增量 HTTP/1.1 请求解析器
+ * 每次传入读缓冲中尚未消费的全部数据，数据不完整时返回 INCOMPLETE，下次从上次扫描的位置继续
+ * 返回 COMPLETE 后 consumed() 为该请求占用的字节数，调用者消费这部分数据后调用 reset()，
+ * 同一缓冲中剩下的数据即流水线中的下一个请求
+ * 缓冲可以在两次调用之间被搬移，只要未消费数据的内容不变
+*/
+class HttpParser {
+public:
+    enum Result { INCOMPLETE, COMPLETE, ERROR };
+
+    static const size_t kMaxHeaderBytes = 64 * 1024;
+    static const size_t kMaxHeaders = 64;
+    static const size_t kMaxBodyBytes = 64 * 1024 * 1024;
+    static const size_t kMaxChunkLineBytes = 4 * 1024;     // chunk-size 行，含扩展
+    static const size_t kMaxTrailerBytes = 16 * 1024;      // 全部 trailer 字段加结尾空行
+
+    HttpParser();
+
+    Result parse(const char* data, size_t len);
+
+    const HttpRequest& request() const {
+        return request_;
+    }
+
+    size_t consumed() const {
+        return consumed_;
+    }
+
+    void reset();
+
+private:
+    enum State { HEADERS, BODY, CHUNK_SIZE, CHUNK_DATA, TRAILERS };
+
+    bool parseHead(const char* data, const char* end);
+    Result parseChunked(const char* data, size_t len);
+    void rebase(const char* data);
+
+    State state_ = HEADERS;
+    const char* base_ = nullptr;    // 上次解析时缓冲的起始地址，缓冲搬移后据此平移 string_view
+    size_t skip_ = 0;               // 请求行之前的空行长度
+    size_t scanPos_ = 0;            // 已确认不含请求头结尾的前缀长度
+    size_t headLen_ = 0;
+    size_t contentLength_ = 0;
+    size_t chunkRemain_ = 0;
+    size_t pos_ = 0;                // chunked 请求体的解析位置
+    size_t trailerStart_ = 0;       // trailer 部分的起始位置
+    size_t consumed_ = 0;
+    std::string chunkBody_;
+    HttpRequest request_;
+};
@@ -0,0 +1,68 @@
+#include "httpResponse.h"
+#include <unistd.h>
+
+HttpResponse::~HttpResponse() {
+    if(fileFd_ >= 0) {
+        close(fileFd_);
+    }
+}
+
+void HttpResponse::reset() {
+    code_ = 200;
+    keepAlive_ = true;
+    contentType_.clear();
+    headers_.clear();
+    body_.clear();
+    raw_.reset();
+    shared_.reset();
+    sharedOffset_ = 0;
+    if(fileFd_ >= 0) {
+        close(fileFd_);
+        fileFd_ = -1;
+    }
+    fileOffset_ = 0;
+    fileLen_ = 0;
+    deferred_ = nullptr;
+    deferDone_ = nullptr;
+}
+
+void HttpResponse::setFile(int fd, off_t offset, size_t len) {
+    if(fileFd_ >= 0) {
+        close(fileFd_);
+    }
+    fileFd_ = fd;
+    fileOffset_ = offset;
+    fileLen_ = len;
+}
+
+int HttpResponse::takeFile(off_t* offset, size_t* len) {
+    int fd = fileFd_;
+    *offset = fileOffset_;
+    *len = fileLen_;
+    fileFd_ = -1;
+    fileOffset_ = 0;
+    fileLen_ = 0;
+    return fd;
+}
+
+const char* HttpResponse::statusText(int code) {
+    switch(code) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <string_view>
+#include <sys/types.h>
+#include "httpParser.h"
+
+/**
+ * 响应构造器，appendTo() 把状态行、响应头和响应体序列化到输出缓冲
+ * 另有三种不经过 body_ 的响应体：
+ *   setRaw()        共享的完整预渲染响应（状态行+响应头+响应体），连接直接发出，忽略其他字段
+ *   setSharedBody() 响应头照常生成，响应体引用共享缓冲的一段，不拷贝
+ *   setFile()       响应体为文件的一段，连接用 sendfile 发出，不经过用户态
+ * 耗时的响应用 defer() 推迟生成，见下
+*/
+class HttpResponse {
+public:
+    HttpResponse() = default;
+    ~HttpResponse();
+    HttpResponse(const HttpResponse&) = delete;
+    HttpResponse& operator=(const HttpResponse&) = delete;
+
+    void reset();
+
+    void setStatus(int code) {
+        code_ = code;
+    }
+
+    int getStatus() const {
+        return code_;
+    }
+
+    void addHeader(std::string_view name, std::string_view value) {
+        headers_.emplace_back(std::string(name), std::string(value));
+    }
+
+    void setContentType(std::string_view type) {
+        contentType_ = type;
+    }
+
+    void setBody(std::string body) {
+        body_ = std::move(body);
+    }
+
+    std::string& body() {
+        return body_;
+    }
+
+    void setKeepAlive(bool on) {
+        keepAlive_ = on;
+    }
+
+    bool isKeepAlive() const {
+        return keepAlive_;
+    }
+
+    // raw 中的 Connection 头须与请求一致，HEAD 请求不要使用
+    void setRaw(std::shared_ptr<const std::string> raw) {
+        raw_ = std::move(raw);
+    }
+
+    const std::shared_ptr<const std::string>& raw() const {
+        return raw_;
+    }
+
+    // 响应体为 buf 从 offset 起到结尾的部分，连接发送期间持有 buf
+    void setSharedBody(std::shared_ptr<const std::string> buf, size_t offset) {
+        shared_ = std::move(buf);
+        sharedOffset_ = offset;
+    }
+
+    const std::shared_ptr<const std::string>& sharedBody() const {
+        return shared_;
+    }
+
+    size_t sharedOffset() const {
+        return sharedOffset_;
+    }
+
+    // fd 的所有权转给响应，未被 takeFile() 取走时在 reset() 或析构时关闭
+    void setFile(int fd, off_t offset, size_t len);
+
+    bool hasFile() const {
+        return fileFd_ >= 0;
+    }
+
+    size_t fileLength() const {
+        return fileLen_;
+    }
+
+    // 取走文件段，调用者负责关闭返回的 fd
+    int takeFile(off_t* offset, size_t* len);
+
+    // 只写状态行和响应头，Content-Length 取 bodyLen
+    // Out 只需提供 append(const char*, size_t)，std::string 与连接的 Buffer 均可
+    template<class Out>
+    void appendHead(Out& out, size_t bodyLen) const {
+        char num[24];
+        put(out, "HTTP/1.1 ");
+        put(out, std::string_view(num, toChars(num, code_)));
+        put(out, " ");
+        put(out, statusText(code_));
+        put(out, "\r\nContent-Length: ");
+        put(out, std::string_view(num, toChars(num, bodyLen)));
+        put(out, keepAlive_ ? "\r\nConnection: keep-alive\r\n" : "\r\nConnection: close\r\n");
+        if(!contentType_.empty()) {
+            put(out, "Content-Type: ");
+            put(out, contentType_);
+            put(out, "\r\n");
+        }
+        for(const auto& h : headers_) {
+            put(out, h.first);
+            put(out, ": ");
+            put(out, h.second);
+            put(out, "\r\n");
+        }
+        put(out, "\r\n");
+    }
+
+    template<class Out>
+    void appendTo(Out& out) const {
+        appendHead(out, body_.size());
+        put(out, body_);
+    }
+
+    typedef std::function<void(HttpResponse&)> Deferred;
+
+    /**
+     * 推迟生成响应：handler 调用后立即返回，work 在线程池上填写本响应，之后回到连接所属的线程发出；
+     * done 非空时在连接所属线程、响应放入输出之前调用
+     * 多 Reactor 模式下 work 不占用事件循环线程；单 Reactor 模式下 handler 已在工作线程上，work 就地执行
+     * work 执行时请求已被消费，需要的请求字段应先拷贝进 work
+     * 同一连接后续的流水线请求等本响应发出后才处理
+     */
+    void defer(Deferred work, std::function<void()> done = nullptr) {
+        deferred_ = std::move(work);
+        deferDone_ = std::move(done);
+    }
+
+    bool isDeferred() const {
+        return static_cast<bool>(deferred_);
+    }
+
+    // 取走 defer() 设置的两个回调
+    void takeDeferred(Deferred* work, std::function<void()>* done) {
+        *work = std::move(deferred_);
+        *done = std::move(deferDone_);
+        deferred_ = nullptr;
+        deferDone_ = nullptr;
+    }
+
+    static const char* statusText(int code);
+
+private:
+    template<class Out>
+    static void put(Out& out, std::string_view s) {
+        out.append(s.data(), s.size());
+    }
+
+    static size_t toChars(char* buf, size_t v) {
+        char tmp[24];
+        size_t n = 0;
+        do {
+            tmp[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while(v > 0);
+        for(size_t i = 0; i < n; ++i) {
+            buf[i] = tmp[n - 1 - i];
+        }
+        return n;
+    }
+
+    int code_ = 200;
+    bool keepAlive_ = true;
+    std::string contentType_;
+    std::vector<std::pair<std::string, std::string>> headers_;
+    std::string body_;
+    std::shared_ptr<const std::string> raw_;
+    std::shared_ptr<const std::string> shared_;
+    size_t sharedOffset_ = 0;
+    int fileFd_ = -1;
+    off_t fileOffset_ = 0;
+    size_t fileLen_ = 0;
+    Deferred deferred_;
+    std::function<void()> deferDone_;
+};
+
+typedef std::function<void(const HttpRequest&, HttpResponse&)> HttpHandler;
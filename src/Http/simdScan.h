@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 请求头解析中的分隔符查找，按编译目标选择实现：
+ * AVX2 每次比较 32 字节；SSE4.2 用 pcmpestri 每次比较 16 字节；其余平台退回 memchr
+ * 需要 -mavx2 / -msse4.2（或 -march=native）才会启用向量版本
+*/
+
+// 返回 [p, end) 中第一个 c 的位置，没有则返回 end
+static inline const char* findChar(const char* p, const char* end, char c) {
+#if defined(__AVX2__)
+    const __m256i needle = _mm256_set1_epi8(c);
+    while(end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle)));
+        if(mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+#elif defined(__SSE4_2__)
+    const __m128i needle = _mm_set1_epi8(c);
+    while(end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int idx = _mm_cmpestri(needle, 1, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if(idx != 16) {
+            return p + idx;
+        }
+        p += 16;
+    }
+#endif
+    const void* hit = memchr(p, c, end - p);
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+// 查找请求头结尾的 "\r\n\r\n"，返回其起始位置，没有则返回 nullptr
+static inline const char* findHeaderEnd(const char* p, const char* end) {
+    while(end - p >= 4) {
+        p = findChar(p, end - 3, '\r');
+        if(p == end - 3) {
+            return nullptr;
+        }
+        if(p[1] == '\n' && p[2] == '\r' && p[3] == '\n') {
+            return p;
+        }
+        ++p;
+    }
+    return nullptr;
+}
@@ -0,0 +1,371 @@
+#include "staticFile.h"
+#include <time.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "yaml-cpp/yaml.h"
+#include "../Log/log.h"
+
+StaticFileHandler::Config StaticFileHandler::Config::loadFile(const std::string& path) {
+    try {
+        YAML::Node root = YAML::LoadFile(path);
+        return fromYaml(root["static"]);
+    }
+    catch(const YAML::Exception& e) {
+        LOG_ERROR(INS()) << "load static config " << path << " failed: " << e.what() << std::endl;
+    }
+    return Config();
+}
+
+StaticFileHandler::Config StaticFileHandler::Config::fromYaml(const YAML::Node& node) {
+    Config config;
+    if(!node.IsDefined() || !node.IsMap()) {
+        return config;
+    }
+    if(node["root"].IsDefined()) {
+        config.root = node["root"].as<std::string>();
+    }
+    if(node["prefix"].IsDefined()) {
+        config.prefix = node["prefix"].as<std::string>();
+    }
+    if(node["capacity"].IsDefined()) {
+        config.capacity = node["capacity"].as<size_t>();
+    }
+    if(node["maxFileSize"].IsDefined()) {
+        config.maxFileSize = node["maxFileSize"].as<size_t>();
+    }
+    if(node["revalidateMs"].IsDefined()) {
+        config.revalidateMs = node["revalidateMs"].as<int>();
+    }
+    return config;
+}
+
+StaticFileHandler::StaticFileHandler(const Config& config) : config_(config) {
+    while(config_.root.size() > 1 && config_.root.back() == '/') {
+        config_.root.pop_back();
+    }
+    if(!config_.root.empty()) {
+        LOG_INFO(INS()) << "serve " << config_.prefix << " from " << config_.root << ", cache capacity "
+                        << config_.capacity << " bytes" << std::endl;
+    }
+}
+
+bool StaticFileHandler::serve(const HttpRequest& req, HttpResponse& resp) {
+    if(config_.root.empty() || req.path.substr(0, config_.prefix.size()) != config_.prefix) {
+        return false;
+    }
+    if(req.method != "GET" && req.method != "HEAD") {
+        resp.setStatus(405);
+        resp.addHeader("Allow", "GET, HEAD");
+        return true;
+    }
+    std::string file;
+    if(!resolve(req.path, &file)) {
+        ++notFound_;
+        resp.setStatus(404);
+        return true;
+    }
+
+    EntryPtr entry = lookup(file);
+    if(entry) {
+        if(fresh(file, *entry)) {
+            ++hits_;
+            respond(*entry, req, resp);
+            return true;
+        }
+        ++invalidations_;
+        erase(file, entry);
+    }
+
+    int fd = -1;
+    off_t size = 0;
+    int64_t mtimeNs = 0;
+    entry = load(file, &fd, &size, &mtimeNs);
+    if(entry) {
+        ++misses_;
+        insert(file, entry);
+        respond(*entry, req, resp);
+        return true;
+    }
+    if(fd < 0) {
+        ++notFound_;
+        resp.setStatus(404);
+        return true;
+    }
+    ++sendfiles_;
+    resp.setContentType(mimeType(file));
+    resp.addHeader("Last-Modified", httpDate(mtimeNs / 1000000000));
+    resp.setFile(fd, 0, size);
+    return true;
+}
+
+static int hexValue(char c) {
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool StaticFileHandler::resolve(std::string_view urlPath, std::string* file) const {
+    std::string path;
+    std::string_view rest = urlPath.substr(config_.prefix.size());
+    path.reserve(rest.size() + 16);
+    for(size_t i = 0; i < rest.size(); ++i) {
+        char c = rest[i];
+        if(c == '%') {
+            int hi = i + 2 < rest.size() ? hexValue(rest[i + 1]) : -1;
+            int lo = hi >= 0 ? hexValue(rest[i + 2]) : -1;
+            if(lo < 0) {
+                return false;
+            }
+            c = static_cast<char>(hi * 16 + lo);
+            i += 2;
+        }
+        if(c == '\0') {
+            return false;
+        }
+        path.push_back(c);
+    }
+    // 逐段检查，不允许 .. 跳出根目录
+    size_t start = 0;
+    while(start <= path.size()) {
+        size_t slash = path.find('/', start);
+        if(slash == std::string::npos) slash = path.size();
+        if(path.compare(start, slash - start, "..") == 0) {
+            return false;
+        }
+        start = slash + 1;
+    }
+    if(path.empty() || path.back() == '/') {
+        path += "index.html";
+    }
+    file->assign(config_.root);
+    if(path.front() != '/') {
+        file->push_back('/');
+    }
+    file->append(path);
+    return true;
+}
+
+StaticFileHandler::Shard& StaticFileHandler::shardOf(const std::string& file) {
+    return shards_[std::hash<std::string>()(file) % kShards];
+}
+
+StaticFileHandler::EntryPtr StaticFileHandler::lookup(const std::string& file) {
+    Shard& shard = shardOf(file);
+    std::lock_guard<std::mutex> lck(shard.mtx);
+    auto it = shard.map.find(file);
+    if(it == shard.map.end()) {
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.pos);
+    return it->second.entry;
+}
+
+void StaticFileHandler::insert(const std::string& file, const EntryPtr& entry) {
+    size_t limit = config_.capacity / kShards;
+    size_t bytes = entry->raw->size();
+    if(bytes > limit) {
+        return;
+    }
+    Shard& shard = shardOf(file);
+    std::lock_guard<std::mutex> lck(shard.mtx);
+    auto it = shard.map.find(file);
+    if(it != shard.map.end()) {
+        // 其他线程同时读入了同一个文件，用新的替换
+        shard.bytes -= it->second.entry->raw->size();
+        it->second.entry = entry;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second.pos);
+    }
+    else {
+        shard.lru.push_front(file);
+        shard.map[file] = Shard::Slot{entry, shard.lru.begin()};
+    }
+    shard.bytes += bytes;
+    // 被淘汰的项若仍有连接在发送，由 shared_ptr 保证发送完才释放
+    while(shard.bytes > limit) {
+        auto victim = shard.map.find(shard.lru.back());
+        shard.bytes -= victim->second.entry->raw->size();
+        shard.map.erase(victim);
+        shard.lru.pop_back();
+        ++evictions_;
+    }
+}
+
+void StaticFileHandler::erase(const std::string& file, const EntryPtr& entry) {
+    Shard& shard = shardOf(file);
+    std::lock_guard<std::mutex> lck(shard.mtx);
+    auto it = shard.map.find(file);
+    if(it == shard.map.end() || it->second.entry != entry) {
+        return;
+    }
+    shard.bytes -= entry->raw->size();
+    shard.lru.erase(it->second.pos);
+    shard.map.erase(it);
+}
+
+static int64_t mtimeOf(const struct stat& st) {
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+bool StaticFileHandler::fresh(const std::string& file, Entry& entry) {
+    int64_t now = nowMs();
+    int64_t last = entry.checkedAt.load(std::memory_order_relaxed);
+    if(now - last < config_.revalidateMs) {
+        return true;
+    }
+    // 只让一个线程去 stat，其余线程在这期间继续使用旧内容
+    if(!entry.checkedAt.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        return true;
+    }
+    struct stat st;
+    if(stat(file.c_str(), &st) < 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    return st.st_size == entry.size && mtimeOf(st) == entry.mtimeNs;
+}
+
+StaticFileHandler::EntryPtr StaticFileHandler::load(const std::string& file, int* fd, off_t* size,
+                                                    int64_t* mtimeNs) {
+    *fd = -1;
+    int f = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if(f < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if(fstat(f, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(f);
+        return nullptr;
+    }
+    *size = st.st_size;
+    *mtimeNs = mtimeOf(st);
+    if(static_cast<size_t>(st.st_size) > config_.maxFileSize || config_.capacity == 0) {
+        *fd = f;
+        return nullptr;
+    }
+
+    std::string body(st.st_size, '\0');
+    size_t done = 0;
+    while(done < body.size()) {
+        ssize_t n = pread(f, &body[done], body.size() - done, done);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        // 读的过程中文件被截断，按 sendfile 处理，由连接在写出时发现
+        if(n <= 0) {
+            lseek(f, 0, SEEK_SET);
+            *fd = f;
+            return nullptr;
+        }
+        done += n;
+    }
+    close(f);
+
+    EntryPtr entry = std::make_shared<Entry>();
+    entry->contentType = std::string(mimeType(file));
+    entry->lastModified = httpDate(st.st_mtim.tv_sec);
+    entry->mtimeNs = *mtimeNs;
+    entry->size = st.st_size;
+    entry->checkedAt.store(nowMs(), std::memory_order_relaxed);
+
+    // 按 keep-alive 渲染完整响应，命中时连同响应头一次写出
+    HttpResponse resp;
+    resp.setContentType(entry->contentType);
+    resp.addHeader("Last-Modified", entry->lastModified);
+    std::string raw;
+    raw.reserve(body.size() + 256);
+    resp.appendHead(raw, body.size());
+    entry->headLen = raw.size();
+    raw.append(body);
+    entry->raw = std::make_shared<const std::string>(std::move(raw));
+    return entry;
+}
+
+void StaticFileHandler::respond(const Entry& entry, const HttpRequest& req, HttpResponse& resp) {
+    if(req.keepAlive && req.method == "GET") {
+        resp.setRaw(entry.raw);
+        return;
+    }
+    // Connection: close 或 HEAD：重新生成响应头，响应体引用缓存中的同一份数据
+    resp.setContentType(entry.contentType);
+    resp.addHeader("Last-Modified", entry.lastModified);
+    resp.setSharedBody(entry.raw, entry.headLen);
+}
+
+StaticFileHandler::Stats StaticFileHandler::stats() {
+    Stats s;
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.misses = misses_.load(std::memory_order_relaxed);
+    s.evictions = evictions_.load(std::memory_order_relaxed);
+    s.invalidations = invalidations_.load(std::memory_order_relaxed);
+    s.sendfiles = sendfiles_.load(std::memory_order_relaxed);
+    s.notFound = notFound_.load(std::memory_order_relaxed);
+    s.cachedFiles = 0;
+    s.cachedBytes = 0;
+    for(Shard& shard : shards_) {
+        std::lock_guard<std::mutex> lck(shard.mtx);
+        s.cachedFiles += shard.map.size();
+        s.cachedBytes += shard.bytes;
+    }
+    return s;
+}
+
+void StaticFileHandler::logStats() {
+    Stats s = stats();
+    uint64_t lookups = s.hits + s.misses;
+    LOG_INFO(INS()) << "static files: hits " << s.hits << ", misses " << s.misses << ", hit rate "
+                    << (lookups ? s.hits * 100.0 / lookups : 0.0) << "%, evictions " << s.evictions
+                    << ", invalidations " << s.invalidations << ", sendfile " << s.sendfiles
+                    << ", not found " << s.notFound << ", cached " << s.cachedFiles << " files / "
+                    << s.cachedBytes << " bytes" << std::endl;
+}
+
+std::string_view StaticFileHandler::mimeType(std::string_view file) {
+    static const std::pair<std::string_view, std::string_view> kTypes[] = {
+        {"html", "text/html; charset=utf-8"},
+        {"htm", "text/html; charset=utf-8"},
+        {"css", "text/css"},
+        {"js", "application/javascript"},
+        {"json", "application/json"},
+        {"txt", "text/plain; charset=utf-8"},
+        {"xml", "application/xml"},
+        {"png", "image/png"},
+        {"jpg", "image/jpeg"},
+        {"jpeg", "image/jpeg"},
+        {"gif", "image/gif"},
+        {"svg", "image/svg+xml"},
+        {"ico", "image/x-icon"},
+        {"webp", "image/webp"},
+        {"woff2", "font/woff2"},
+        {"wasm", "application/wasm"},
+        {"pdf", "application/pdf"},
+        {"mp4", "video/mp4"},
+    };
+    size_t dot = file.rfind('.');
+    size_t slash = file.rfind('/');
+    if(dot != std::string_view::npos && (slash == std::string_view::npos || dot > slash)) {
+        std::string_view ext = file.substr(dot + 1);
+        for(const auto& t : kTypes) {
+            if(t.first == ext) {
+                return t.second;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+std::string StaticFileHandler::httpDate(int64_t sec) {
+    time_t t = static_cast<time_t>(sec);
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char buf[64];
+    size_t n = strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return std::string(buf, n);
+}
+
+int64_t StaticFileHandler::nowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
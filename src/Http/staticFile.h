@@ -0,0 +1,118 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include "httpParser.h"
+#include "httpResponse.h"
+
+namespace YAML {
+class Node;
+}
+
+/**
+ * 静态文件处理器，把 prefix 开头的 GET/HEAD 请求映射到 root 目录下的文件
+ * 不超过 maxFileSize 的文件整份读入内存，连同预渲染好的响应头缓存在 LRU 中，命中时整份响应一次写出；
+ * Connection: close 与 HEAD 请求另行生成响应头，响应体仍引用缓存中的同一份数据；
+ * 更大的文件每次打开，响应体由连接用 sendfile 发送，不经过用户态
+ * 缓存项最多每 revalidateMs 毫秒 stat 一次，修改时间或大小变化即重新读取
+ * 缓存按路径哈希分片，每片一把锁，锁内只做查表和调整 LRU 顺序，读文件和 stat 都在锁外
+ *
+ * 配置可以和日志配置放在同一个 YAML 文件中：
+ *   static:
+ *     root: ./www
+ *     prefix: /static/
+ *     capacity: 67108864      # 缓存总字节数
+ *     maxFileSize: 262144     # 超过该大小的文件不缓存，走 sendfile
+ *     revalidateMs: 1000
+*/
+class StaticFileHandler {
+public:
+    struct Config {
+        std::string root;                   // 为空时不处理任何请求
+        std::string prefix = "/static/";
+        size_t capacity = 64 * 1024 * 1024;
+        size_t maxFileSize = 256 * 1024;
+        int revalidateMs = 1000;
+
+        // 读取 YAML 文件中的 static 节点，文件或节点不存在时返回默认配置
+        static Config loadFile(const std::string& path);
+        static Config fromYaml(const YAML::Node& node);
+    };
+
+    struct Stats {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        uint64_t invalidations;     // 因文件被修改而丢弃的缓存项
+        uint64_t sendfiles;         // 走 sendfile 的大文件响应
+        uint64_t notFound;
+        size_t cachedFiles;
+        size_t cachedBytes;
+    };
+
+    explicit StaticFileHandler(const Config& config);
+
+    // 请求不属于本处理器时返回 false，resp 不变
+    bool serve(const HttpRequest& req, HttpResponse& resp);
+
+    Stats stats();
+    void logStats();
+
+private:
+    // 一个缓存的文件：raw 为 keep-alive 的完整响应，前 headLen 字节为响应头，其后为响应体
+    struct Entry {
+        std::shared_ptr<const std::string> raw;
+        size_t headLen;
+        std::string contentType;
+        std::string lastModified;
+        int64_t mtimeNs;
+        off_t size;
+        std::atomic<int64_t> checkedAt;     // 上次 stat 的时间，毫秒
+    };
+    typedef std::shared_ptr<Entry> EntryPtr;
+
+    struct Shard {
+        std::mutex mtx;
+        std::list<std::string> lru;         // 表头最近使用
+        struct Slot {
+            EntryPtr entry;
+            std::list<std::string>::iterator pos;
+        };
+        std::unordered_map<std::string, Slot> map;
+        size_t bytes = 0;
+    };
+
+    static const size_t kShards = 16;
+
+    // 把 URL 路径解码并转换为 root 下的文件路径，含 .. 等非法路径时返回 false
+    bool resolve(std::string_view urlPath, std::string* file) const;
+    Shard& shardOf(const std::string& file);
+    EntryPtr lookup(const std::string& file);
+    void insert(const std::string& file, const EntryPtr& entry);
+    void erase(const std::string& file, const EntryPtr& entry);
+    // 缓存项过了检查间隔时 stat 一次，文件未变返回 true
+    bool fresh(const std::string& file, Entry& entry);
+    // 读文件建立缓存项；文件过大时返回空，由 fd/st 交给调用者走 sendfile
+    EntryPtr load(const std::string& file, int* fd, off_t* size, int64_t* mtimeNs);
+    void respond(const Entry& entry, const HttpRequest& req, HttpResponse& resp);
+
+    static std::string_view mimeType(std::string_view file);
+    static std::string httpDate(int64_t sec);
+    static int64_t nowMs();
+
+    Config config_;
+    Shard shards_[kShards];
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> invalidations_{0};
+    std::atomic<uint64_t> sendfiles_{0};
+    std::atomic<uint64_t> notFound_{0};
+};
@@ -177,6 +177,7 @@ namespace Lwy
                 break;
             case 's':
                 m_os << msg->getPtime()->tm_sec;
+                break;
             case 'q':
                 m_os << msg->getUtime().tv_usec / 1000;
             default:
@@ -405,7 +406,7 @@ namespace Lwy
     {
     }
 
-    Logger::Logger(const Logger & logger) {
+    Logger::Logger(const Logger &) {
 
     }
     void Logger::setAppenders(Appender::ptr appender)
@@ -485,9 +486,7 @@ namespace Lwy
 
     Temp::~Temp()
     {
-        LogMsg::ptr msg(std::make_shared<LogMsg>(m_logger->getOs().str(), m_level, m_fileName, m_line));
+        LogMsg::ptr msg(std::make_shared<LogMsg>(m_os.str(), m_level, m_fileName, m_line));
         m_logger->getAppender()->output(msg, std::cout);
-        m_logger->getOs().clear();
-        m_logger->getOs().str("");
     }
 }
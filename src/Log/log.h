@@ -7,6 +7,7 @@
 #include <functional>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <map>
 #include <mutex>
 #include <sys/time.h>
@@ -109,7 +110,7 @@ namespace Lwy
     {
     public:
         typedef std::shared_ptr<ConsoleAppender> ptr;
-        void output(const LogMsg::ptr &msg, std::ostream& os = std::cout) override { Appender::output(msg, std::cout); }
+        void output(const LogMsg::ptr &msg, std::ostream& = std::cout) override { Appender::output(msg, std::cout); }
     };
 
     // 文件日志输出器
@@ -122,7 +123,7 @@ namespace Lwy
     public:
         typedef std::shared_ptr<FileAppender> ptr;
         FileAppender(const std::string &);
-        void output(const LogMsg::ptr &msg, std::ostream& os = std::cout) override { Appender::output(msg, m_os); }
+        void output(const LogMsg::ptr &msg, std::ostream& = std::cout) override { Appender::output(msg, m_os); }
     };
 
     //配置器
@@ -212,10 +213,12 @@ namespace Lwy
         }
 
         ~Temp();
+        // 每条日志使用自己的缓冲，多线程同时写同一个日志器时互不干扰
         std::stringstream& getOs() {
-            return m_logger->getOs();
+            return m_os;
         }
     private:
+        std::stringstream m_os;
         Logger::ptr m_logger;
         LogLevel::Level m_level;
         std::string m_fileName;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ThreadCache.hpp"
+
+/**
+ * 内存池对外接口，释放时需要传回申请时的大小
+ * 不超过 MAXBYTES 的请求走线程缓存，更大的直接交给系统
+ * 定义 WEBSERVER_USE_MALLOC 时全部直接使用 malloc/free，用于对比测试
+*/
+#ifdef WEBSERVER_USE_MALLOC
+static inline void *ConcurrentAlloc(size_t size)
+{
+    void *ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+static inline void ConcurrentFree(void *ptr, size_t)
+{
+    free(ptr);
+}
+#else
+static inline void *ConcurrentAlloc(size_t size)
+{
+    if (size == 0)
+    {
+        size = 1;
+    }
+    if (size > MAXBYTES)
+    {
+        void *ptr = malloc(size);
+        if (ptr == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+    return ThreadCache::getInstance().allocate(size);
+}
+
+static inline void ConcurrentFree(void *ptr, size_t size)
+{
+    if (ptr == nullptr)
+    {
+        return;
+    }
+    if (size == 0)
+    {
+        size = 1;
+    }
+    if (size > MAXBYTES)
+    {
+        free(ptr);
+        return;
+    }
+    ThreadCache::getInstance().deallocate(ptr, size);
+}
+#endif
@@ -6,7 +6,7 @@
 #include <cstdlib>
 #include "../Log/log.h"
 
-const size_t NLISTS = 240; // 管理自由链表数组的长度,根据对齐规则计算出来的
+const size_t NLISTS = 232; // 管理自由链表数组的长度,根据对齐规则计算出来的
 
 const size_t MAXBYTES = 64 * 1024; // ThreadCache最大可以一次分配多大的内存64K
 
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <algorithm>
+#include "Utils.hpp"
+
+// 中心缓存：所有线程共享，每个大小类一把锁，向系统按页申请后切分成等长节点
+class CentralCache
+{
+public:
+    // 进程内唯一，故意不析构：分离线程可能在进程退出时仍在归还内存
+    static CentralCache *getInstance()
+    {
+        static CentralCache *inst = new CentralCache;
+        return inst;
+    }
+
+    // 取出最多 num 个节点，返回实际数量
+    size_t fetchRange(void *&start, void *&end, size_t num, size_t size)
+    {
+        Bucket &bucket = buckets_[SizeClass::index(size)];
+        std::lock_guard<std::mutex> lck(bucket.mtx_);
+        if (bucket.list_.empty())
+        {
+            refill(bucket, size);
+        }
+        if (num > bucket.list_.getSize())
+        {
+            num = bucket.list_.getSize();
+        }
+        bucket.list_.popRange(start, end, num);
+        return num;
+    }
+
+    void releaseRange(void *start, void *end, size_t num, size_t size)
+    {
+        Bucket &bucket = buckets_[SizeClass::index(size)];
+        std::lock_guard<std::mutex> lck(bucket.mtx_);
+        bucket.list_.pushRange(start, end, num);
+    }
+
+private:
+    struct Bucket
+    {
+        Bucket(size_t size) : list_(size) {}
+        std::mutex mtx_;
+        BuffList list_;
+    };
+
+    CentralCache()
+    {
+        for (size_t i = 0; i < NLISTS; ++i)
+        {
+            buckets_.emplace_back(0);
+        }
+    }
+
+    // 申请 numMovePage 页并切分成 size 大小的节点挂到链表上
+    void refill(Bucket &bucket, size_t size)
+    {
+        size_t pages = SizeClass::numMovePage(size);
+        char *start = static_cast<char *>(SysAlloc(pages));
+        size_t num = (pages << PAGE_SHIFT) / size;
+        char *cur = start;
+        for (size_t i = 1; i < num; ++i)
+        {
+            NextBuff(cur) = cur + size;
+            cur += size;
+        }
+        bucket.list_.pushRange(start, cur, num);
+    }
+
+    std::deque<Bucket> buckets_;
+};
+
+// 线程缓存：每个线程一份，无锁分配；链表过长时把一批节点归还中心缓存
+class ThreadCache
+{
+public:
+    static ThreadCache &getInstance()
+    {
+        static thread_local ThreadCache tc;
+        return tc;
+    }
+
+    void *allocate(size_t size)
+    {
+        size = SizeClass::roundUp(size);
+        BuffList &list = lists_[SizeClass::index(size)];
+        if (list.empty())
+        {
+            fetchFromCentral(list, size);
+        }
+        return list.pop();
+    }
+
+    void deallocate(void *ptr, size_t size)
+    {
+        size = SizeClass::roundUp(size);
+        size_t idx = SizeClass::index(size);
+        BuffList &list = lists_[idx];
+        sizes_[idx] = size;
+        list.push(ptr);
+        if (list.getSize() >= list.getMaxSize() + SizeClass::numMoveSize(size))
+        {
+            releaseToCentral(list, SizeClass::numMoveSize(size), size);
+        }
+    }
+
+    // 线程退出时全部归还中心缓存，供其他线程复用
+    ~ThreadCache()
+    {
+        for (size_t i = 0; i < NLISTS; ++i)
+        {
+            BuffList &list = lists_[i];
+            if (!list.empty())
+            {
+                releaseToCentral(list, list.getSize(), sizes_[i]);
+            }
+        }
+    }
+
+private:
+    ThreadCache()
+    {
+        for (size_t i = 0; i < NLISTS; ++i)
+        {
+            lists_.emplace_back(0);
+            sizes_[i] = 0;
+        }
+    }
+
+    // 慢启动：每次取的批量从 1 开始增长到 numMoveSize
+    void fetchFromCentral(BuffList &list, size_t size)
+    {
+        size_t batch = std::min(list.getMaxSize(), SizeClass::numMoveSize(size));
+        if (batch == list.getMaxSize())
+        {
+            list.setMaxSize(batch + 1);
+        }
+        void *start = nullptr, *end = nullptr;
+        size_t num = CentralCache::getInstance()->fetchRange(start, end, batch, size);
+        list.pushRange(start, end, num);
+        sizes_[SizeClass::index(size)] = size;
+    }
+
+    void releaseToCentral(BuffList &list, size_t num, size_t size)
+    {
+        void *start = nullptr, *end = nullptr;
+        list.popRange(start, end, num);
+        CentralCache::getInstance()->releaseRange(start, end, num, size);
+    }
+
+    std::deque<BuffList> lists_;
+    size_t sizes_[NLISTS]; // 各链表的节点大小，析构归还时使用
+};
@@ -29,6 +29,20 @@ public:
         nodeCount += num;
     }
 
+    // 弹出前 num 个节点，start 为首节点，end 为尾节点
+    void popRange(void *&start, void *&end, size_t num)
+    {
+        assert(num > 0 && num <= nodeCount);
+        start = end = head_;
+        for (size_t i = 1; i < num; ++i)
+        {
+            end = NextBuff(end);
+        }
+        head_ = NextBuff(end);
+        NextBuff(end) = nullptr;
+        nodeCount -= num;
+    }
+
     // 弹出头节点
     void *pop()
     {
@@ -84,11 +98,70 @@ public:
 
 private:
     void *head_ = nullptr; // 链表的头结点
-    size_t nodeCount;      // 节点数量
-    size_t maxSize_;       // 最多节点数量
+    size_t nodeCount = 0;  // 节点数量
+    size_t maxSize_ = 1;   // 最多节点数量
     size_t nodeSize_;      // 节点的内存大小
 };
 
+// 大小类：把申请的字节数对齐并映射到自由链表下标，控制内碎片在 12% 左右
+// 最小按 16 字节对齐，与 operator new 的 __STDCPP_DEFAULT_NEW_ALIGNMENT__ 一致，协程帧和连接对象可以直接放在池中
+// [1,1024]           16byte对齐    freelist[0,64)
+// [1025,8*1024]      128byte对齐   freelist[64,120)
+// [8*1024+1,64*1024] 512byte对齐   freelist[120,232)
+class SizeClass
+{
+public:
+    static inline size_t roundUp(size_t size)
+    {
+        assert(size > 0 && size <= MAXBYTES);
+        if (size <= 1024)
+            return alignUp(size, 4);
+        else if (size <= 8 * 1024)
+            return alignUp(size, 7);
+        return alignUp(size, 9);
+    }
+
+    static inline size_t index(size_t size)
+    {
+        assert(size > 0 && size <= MAXBYTES);
+        static const size_t groups[] = {64, 56};
+        if (size <= 1024)
+            return indexIn(size, 4);
+        else if (size <= 8 * 1024)
+            return indexIn(size - 1024, 7) + groups[0];
+        return indexIn(size - 8 * 1024, 9) + groups[0] + groups[1];
+    }
+
+    // 线程缓存一次从中心缓存批量获取的节点数，小对象多取、大对象少取
+    static inline size_t numMoveSize(size_t size)
+    {
+        size_t num = MAXBYTES / size;
+        if (num < 2)
+            num = 2;
+        if (num > 512)
+            num = 512;
+        return num;
+    }
+
+    // 中心缓存一次向系统申请的页数
+    static inline size_t numMovePage(size_t size)
+    {
+        size_t pages = (numMoveSize(size) * size) >> PAGE_SHIFT;
+        return pages == 0 ? 1 : pages;
+    }
+
+private:
+    static inline size_t alignUp(size_t size, size_t shift)
+    {
+        return (size + (1 << shift) - 1) & ~((size_t(1) << shift) - 1);
+    }
+
+    static inline size_t indexIn(size_t size, size_t shift)
+    {
+        return ((size + (1 << shift) - 1) >> shift) - 1;
+    }
+};
+
 // 页链表，同一大小的页节点链表，一个节点包含多个页
 struct SamePageList
 {
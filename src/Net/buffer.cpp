@@ -0,0 +1,91 @@
+#include "buffer.h"
+#include <errno.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/uio.h>
+#include "../MemoryPool/ConcurrentAlloc.hpp"
+
+Buffer::Buffer(size_t initSize)
+    : buf_(static_cast<char*>(ConcurrentAlloc(initSize))), cap_(initSize), initSize_(initSize) {
+}
+
+Buffer::~Buffer() {
+    ConcurrentFree(buf_, cap_);
+}
+
+void Buffer::retrieve(size_t len) {
+    assert(len <= readableBytes());
+    readPos_ += len;
+    if(readPos_ == writePos_) {
+        readPos_ = writePos_ = 0;
+    }
+}
+
+void Buffer::retrieveAll() {
+    readPos_ = writePos_ = 0;
+}
+
+void Buffer::append(const char* data, size_t len) {
+    ensureWritable(len);
+    memcpy(buf_ + writePos_, data, len);
+    writePos_ += len;
+}
+
+void Buffer::ensureWritable(size_t len) {
+    if(writableBytes() < len) {
+        makeSpace(len);
+    }
+}
+
+void Buffer::shrinkIfEmpty() {
+    if(readableBytes() == 0 && cap_ > initSize_) {
+        ConcurrentFree(buf_, cap_);
+        buf_ = static_cast<char*>(ConcurrentAlloc(initSize_));
+        cap_ = initSize_;
+        readPos_ = writePos_ = 0;
+    }
+}
+
+// 前面已读的空间足够且可读数据不多时原地搬移，否则按两倍扩容
+void Buffer::makeSpace(size_t len) {
+    size_t readable = readableBytes();
+    if(writableBytes() + readPos_ >= len && readable <= cap_ / 2) {
+        memmove(buf_, buf_ + readPos_, readable);
+    }
+    else {
+        size_t cap = cap_ * 2;
+        while(cap < readable + len) {
+            cap *= 2;
+        }
+        char* buf = static_cast<char*>(ConcurrentAlloc(cap));
+        memcpy(buf, buf_ + readPos_, readable);
+        ConcurrentFree(buf_, cap_);
+        buf_ = buf;
+        cap_ = cap;
+    }
+    readPos_ = 0;
+    writePos_ = readable;
+}
+
+ssize_t Buffer::readFd(int fd, int* saveErrno) {
+    char extra[kExtraSize];
+    struct iovec iov[2];
+    const size_t writable = writableBytes();
+    iov[0].iov_base = buf_ + writePos_;
+    iov[0].iov_len = writable;
+    iov[1].iov_base = extra;
+    iov[1].iov_len = sizeof(extra);
+
+    const ssize_t len = readv(fd, iov, 2);
+    if(len < 0) {
+        *saveErrno = errno;
+    }
+    else if(static_cast<size_t>(len) <= writable) {
+        writePos_ += len;
+    }
+    else {
+        writePos_ = cap_;
+        append(extra, len - writable);
+    }
+    return len;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <string_view>
+#include <sys/types.h>
+
+/**
+ * 连接的读写缓冲，内存来自内存池
+ * | 已读 (readPos_) | 可读 | 可写 |
+ * 消费数据只移动 readPos_，缓冲读空时两个指针归零；只有空间不够时才搬移或扩容（惰性整理）
+*/
+class Buffer {
+public:
+    static const size_t kInitSize = 4096;
+    static const size_t kExtraSize = 65536;     // readFd 时栈上溢出区的大小
+
+    explicit Buffer(size_t initSize = kInitSize);
+    ~Buffer();
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    size_t readableBytes() const {
+        return writePos_ - readPos_;
+    }
+
+    size_t writableBytes() const {
+        return cap_ - writePos_;
+    }
+
+    const char* peek() const {
+        return buf_ + readPos_;
+    }
+
+    std::string_view view() const {
+        return std::string_view(peek(), readableBytes());
+    }
+
+    void retrieve(size_t len);
+    void retrieveAll();
+
+    void append(const char* data, size_t len);
+    void append(std::string_view str) {
+        append(str.data(), str.size());
+    }
+
+    // 保证至少有 len 字节可写
+    void ensureWritable(size_t len);
+
+    // 缓冲为空且容量超过初始大小时归还多余内存，长连接空闲时不长期占用大块内存
+    void shrinkIfEmpty();
+
+    // 一次 readv 读到可写区和栈上溢出区，溢出部分再追加进缓冲
+    ssize_t readFd(int fd, int* saveErrno);
+
+private:
+    void makeSpace(size_t len);
+
+    char* buf_;
+    size_t cap_;
+    size_t initSize_;
+    size_t readPos_ = 0;
+    size_t writePos_ = 0;
+};
@@ -0,0 +1,309 @@
+#include "connection.h"
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include "../MemoryPool/ConcurrentAlloc.hpp"
+
+void* Connection::operator new(size_t size) {
+    return ConcurrentAlloc(size);
+}
+
+void Connection::operator delete(void* ptr, size_t size) {
+    ConcurrentFree(ptr, size);
+}
+
+Connection::Connection(int fd, const sockaddr_in& addr, uint64_t id, const HttpHandler* handler)
+    : fd_(fd), id_(id), addr_(addr), handler_(handler), lastActive_(nowMs()) {
+}
+
+Connection::~Connection() {
+    closeFile();
+    if(fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+int64_t Connection::nowMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void Connection::touch(int64_t now) {
+    lastActive_.store(now, std::memory_order_relaxed);
+    // 有待写输出时按空闲超时处理，慢速读取的客户端由写进度刷新活跃时间
+    if(inBuf_.readableBytes() == 0 || toWriteBytes() > 0) {
+        requestStart_.store(0, std::memory_order_relaxed);
+    }
+    else if(requestStart_.load(std::memory_order_relaxed) == 0) {
+        requestStart_.store(now, std::memory_order_relaxed);
+    }
+}
+
+void Connection::closeFile() {
+    if(fileFd_ >= 0) {
+        close(fileFd_);
+        fileFd_ = -1;
+    }
+    fileOff_ = 0;
+    fileLeft_ = 0;
+}
+
+ssize_t Connection::read(int* saveErrno) {
+    ssize_t total = 0;
+    while(true) {
+        size_t want = inBuf_.writableBytes() + Buffer::kExtraSize;
+        ssize_t len = inBuf_.readFd(fd_, saveErrno);
+        if(len > 0) {
+            total += len;
+            // 没读满说明内核缓冲已读空，边沿触发下可以省掉一次返回 EAGAIN 的 read
+            if(static_cast<size_t>(len) < want) {
+                break;
+            }
+        }
+        else if(len == 0) {
+            peerClosed_ = true;
+            break;
+        }
+        else if(*saveErrno == EINTR) {
+            continue;
+        }
+        else {
+            if(*saveErrno != EAGAIN && *saveErrno != EWOULDBLOCK) {
+                return -1;
+            }
+            *saveErrno = 0;
+            break;
+        }
+    }
+    return total;
+}
+
+int Connection::pendingIov(struct iovec* iov) {
+    int cnt = 0;
+    if(outBuf_.readableBytes() > 0) {
+        iov[cnt].iov_base = const_cast<char*>(outBuf_.peek());
+        iov[cnt].iov_len = outBuf_.readableBytes();
+        ++cnt;
+    }
+    if(extLeft() > 0) {
+        iov[cnt].iov_base = const_cast<char*>(ext_->data() + extPos_);
+        iov[cnt].iov_len = extLeft();
+        ++cnt;
+    }
+    return cnt;
+}
+
+void Connection::retrieveOutput(size_t n) {
+    size_t fromBuf = n < outBuf_.readableBytes() ? n : outBuf_.readableBytes();
+    outBuf_.retrieve(fromBuf);
+    extPos_ += n - fromBuf;
+    finishWrite();
+}
+
+ssize_t Connection::sendFile(int* saveErrno) {
+    ssize_t total = 0;
+    while(fileLeft_ > 0) {
+        ssize_t len = sendfile(fd_, fileFd_, &fileOff_, fileLeft_);
+        if(len < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                *saveErrno = errno;
+                return -1;
+            }
+            break;
+        }
+        // 文件在发送过程中被截断，已发出的 Content-Length 无法兑现，只能断开
+        if(len == 0) {
+            *saveErrno = EIO;
+            return -1;
+        }
+        total += len;
+        fileLeft_ -= len;
+    }
+    finishWrite();
+    return total;
+}
+
+ssize_t Connection::write(int* saveErrno) {
+    ssize_t total = 0;
+    while(toWriteBytes() > 0) {
+        struct iovec iov[2];
+        int cnt = pendingIov(iov);
+        if(cnt == 0) {
+            ssize_t len = sendFile(saveErrno);
+            if(len < 0) {
+                return -1;
+            }
+            total += len;
+            break;
+        }
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = cnt;
+        // 后面还有文件段时带 MSG_MORE，响应头与文件开头合并成满的报文发出
+        ssize_t len = sendmsg(fd_, &msg, fileLeft_ > 0 ? MSG_MORE : 0);
+        if(len < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                *saveErrno = errno;
+                return -1;
+            }
+            break;
+        }
+        total += len;
+        retrieveOutput(len);
+    }
+    return total;
+}
+
+// 全部写完后释放共享响应体与文件，收缩输出缓冲
+void Connection::finishWrite() {
+    if(toWriteBytes() == 0) {
+        ext_.reset();
+        extPos_ = 0;
+        closeFile();
+        outBuf_.shrinkIfEmpty();
+    }
+}
+
+void Connection::process() {
+    blocked_ = false;
+    if(deferred_) {
+        return;
+    }
+    if(extLeft() > 0 || fileLeft_ > 0) {
+        blocked_ = true;
+        return;
+    }
+    while(keepAlive_ && inBuf_.readableBytes() > 0) {
+        HttpParser::Result ret = parser_.parse(inBuf_.peek(), inBuf_.readableBytes());
+        if(ret == HttpParser::INCOMPLETE) {
+            break;
+        }
+        response_.reset();
+        if(ret == HttpParser::ERROR) {
+            response_.setStatus(400);
+            response_.setKeepAlive(false);
+            response_.appendTo(outBuf_);
+            keepAlive_ = false;
+            inBuf_.retrieveAll();
+            parser_.reset();
+            break;
+        }
+        const HttpRequest& req = parser_.request();
+        response_.setKeepAlive(req.keepAlive);
+        requestStart_.store(0, std::memory_order_relaxed);
+        if(rejecting_) {
+            response_.setStatus(503);
+            response_.setKeepAlive(false);
+            response_.addHeader("Retry-After", "1");
+        }
+        else if(handler_ && *handler_) {
+            (*handler_)(req, response_);
+        }
+        else {
+            response_.setStatus(404);
+        }
+        keepAlive_ = response_.isKeepAlive();
+        bool head = req.method == "HEAD";
+        inBuf_.retrieve(parser_.consumed());
+        parser_.reset();
+
+        if(response_.isDeferred()) {
+            // 响应由线程池上的工作填写，保留 response_，等 finishDeferred() 再放入输出
+            response_.takeDeferred(&deferWork_, &deferDone_);
+            deferred_ = true;
+            deferHead_ = head;
+            return;
+        }
+        if(appendResponse(head)) {
+            blocked_ = keepAlive_ && inBuf_.readableBytes() > 0;
+            break;
+        }
+    }
+    // 不让空闲连接继续持有缓存项的引用
+    response_.reset();
+    inBuf_.shrinkIfEmpty();
+}
+
+std::function<void()> Connection::takeDeferred() {
+    if(!deferWork_) {
+        return nullptr;
+    }
+    HttpResponse::Deferred work = std::move(deferWork_);
+    deferWork_ = nullptr;
+    return [this, work]() {
+        work(response_);
+    };
+}
+
+void Connection::finishDeferred() {
+    if(deferDone_) {
+        deferDone_();
+        deferDone_ = nullptr;
+    }
+    deferred_ = false;
+    keepAlive_ = response_.isKeepAlive();
+    appendResponse(deferHead_);
+    // 推迟期间到达的后续请求留在 inBuf_ 中，交给下一次 process()
+    blocked_ = keepAlive_ && inBuf_.readableBytes() > 0;
+    response_.reset();
+    inBuf_.shrinkIfEmpty();
+}
+
+// 把 response_ 放入输出，返回 true 表示放入了共享响应体或文件段，需要先写完再处理后续请求
+bool Connection::appendResponse(bool head) {
+    const std::shared_ptr<const std::string>& raw = response_.raw();
+    if(raw && !head) {
+        if(raw->size() <= kInlineBodyMax) {
+            outBuf_.append(*raw);
+            return false;
+        }
+        ext_ = raw;
+        extPos_ = 0;
+        return true;
+    }
+    const std::shared_ptr<const std::string>& shared = response_.sharedBody();
+    if(shared) {
+        size_t offset = response_.sharedOffset();
+        size_t len = shared->size() - offset;
+        response_.appendHead(outBuf_, len);
+        if(head) {
+            return false;
+        }
+        if(len <= kInlineBodyMax) {
+            outBuf_.append(shared->data() + offset, len);
+            return false;
+        }
+        ext_ = shared;
+        extPos_ = offset;
+        return true;
+    }
+    if(response_.hasFile()) {
+        response_.appendHead(outBuf_, response_.fileLength());
+        if(head || response_.fileLength() == 0) {
+            return false;
+        }
+        fileFd_ = response_.takeFile(&fileOff_, &fileLeft_);
+        return true;
+    }
+    std::string& body = response_.body();
+    response_.appendHead(outBuf_, body.size());
+    if(head) {
+        return false;
+    }
+    if(body.size() <= kInlineBodyMax) {
+        outBuf_.append(body);
+        return false;
+    }
+    ext_ = std::make_shared<std::string>(std::move(body));
+    extPos_ = 0;
+    return true;
+}
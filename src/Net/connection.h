@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include "buffer.h"
+#include "../Http/httpParser.h"
+#include "../Http/httpResponse.h"
+
+/**
+ * 一个客户端连接：非阻塞 fd 与读写缓冲
+ * 边沿触发 + EPOLLONESHOT，同一时刻只有一个工作线程操作同一个连接，内部不加锁
+ * 对象本身与读写缓冲都从内存池分配
+ * 输出由三段依次组成：输出缓冲、共享响应体 ext_、文件段
+ * 响应头和小响应体拷贝进输出缓冲；大响应体和大的预渲染响应放入 ext_，与输出缓冲一起用一次 writev 发出；
+ * 文件段在前两段写完后用 sendfile 发出
+ * 后两段未写完时暂停处理流水线中后续的请求，保证响应顺序，见 isBlocked()
+ * 超时判定所需的最后活跃时间与请求开始时间由后端在每次读写后经 touch() 更新，
+ * 单 Reactor 模式下定时器在主线程读取，因此这两项为原子变量
+*/
+class Connection {
+public:
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr, size_t size);
+
+    // handler 由服务器持有，生命周期长于连接；为空时所有请求返回 404
+    static const size_t kInlineBodyMax = 16 * 1024;   // 超过该大小的响应体或预渲染响应不拷贝进输出缓冲
+
+    Connection(int fd, const sockaddr_in& addr, uint64_t id, const HttpHandler* handler);
+    ~Connection();
+
+    // 读到 EAGAIN 或读不满为止，返回本次读到的字节数；出错返回 -1 并设置 saveErrno
+    ssize_t read(int* saveErrno);
+    // 用 writev / sendfile 一直写到全部写完或 EAGAIN，返回本次写出的字节数；出错返回 -1 并设置 saveErrno
+    ssize_t write(int* saveErrno);
+
+    // 以下供完成式后端（io_uring）使用：数据由后端收发，连接只负责缓冲与协议处理
+    // 追加已收到的数据
+    void appendInput(const char* data, size_t len) {
+        inBuf_.append(data, len);
+    }
+    void setPeerClosed() {
+        peerClosed_ = true;
+    }
+    // 把输出缓冲和共享响应体中待写的数据填入 iov（至多 2 个），返回个数；在途期间不能调用 process()
+    int pendingIov(struct iovec* iov);
+    // pendingIov() 给出的数据已写出 n 字节
+    void retrieveOutput(size_t n);
+    // 前两段写完、只剩文件段
+    bool hasFilePending() const {
+        return fileLeft_ > 0 && outBuf_.readableBytes() == 0 && extLeft() == 0;
+    }
+    // 用 sendfile 写文件段，直到写完或 EAGAIN，出错返回 -1 并设置 saveErrno
+    ssize_t sendFile(int* saveErrno);
+
+    // 解析输入缓冲中所有完整的请求（支持流水线），依次调用 handler 并把响应追加到输出缓冲
+    void process();
+
+    size_t toWriteBytes() const {
+        return outBuf_.readableBytes() + extLeft() + fileLeft_;
+    }
+
+    // 因大响应体或文件暂停了流水线，输出写完后需要再次调用 process()
+    bool isBlocked() const {
+        return blocked_;
+    }
+
+    // 对端已关闭写端，或请求要求关闭连接；输出写完后应关闭。等待推迟的响应期间不关闭
+    bool isClosing() const {
+        return !deferred_ && (peerClosed_ || !keepAlive_);
+    }
+
+    // handler 调用了 HttpResponse::defer()，在 finishDeferred() 之前 process() 不再处理后续请求
+    bool isDeferred() const {
+        return deferred_;
+    }
+
+    // 取出生成推迟响应的工作，只能取出一次，之后返回空；
+    // 返回的函数可在任意线程执行，只写本连接的响应对象，执行完之前连接不能释放，也不能调用 finishDeferred()
+    std::function<void()> takeDeferred();
+
+    // 工作执行完后在连接所属线程调用：把响应放入输出；isBlocked() 为 true 时需再次调用 process()
+    void finishDeferred();
+
+    // 过载时置位：之后解析出的请求不再调用 handler，直接回 503 并在写完后关闭连接
+    void setRejecting(bool on) {
+        rejecting_ = on;
+    }
+
+    bool isRejecting() const {
+        return rejecting_;
+    }
+
+    // 一次读写处理之后调用：记录活跃时间；输入中留有未收齐的请求且没有待写输出时，记下请求开始的时间
+    void touch(int64_t now);
+
+    int64_t lastActive() const {
+        return lastActive_.load(std::memory_order_relaxed);
+    }
+
+    // 正在接收的请求收到首字节的时间，0 表示没有
+    int64_t requestStart() const {
+        return requestStart_.load(std::memory_order_relaxed);
+    }
+
+    // 后端为连接挂的超时定时器
+    void setTimer(uint64_t id) {
+        timer_ = id;
+    }
+
+    uint64_t timer() const {
+        return timer_;
+    }
+
+    // 单调时钟的毫秒数，精度为一个调度周期
+    static int64_t nowMs();
+
+    int getFd() const {
+        return fd_;
+    }
+
+    uint64_t getId() const {
+        return id_;
+    }
+
+    const sockaddr_in& getAddr() const {
+        return addr_;
+    }
+
+private:
+    size_t extLeft() const {
+        return ext_ ? ext_->size() - extPos_ : 0;
+    }
+
+    bool appendResponse(bool head);
+    void finishWrite();
+    void closeFile();
+
+    int fd_;
+    uint64_t id_;
+    sockaddr_in addr_;
+    const HttpHandler* handler_;
+    HttpParser parser_;
+    HttpResponse response_;
+    Buffer inBuf_;
+    Buffer outBuf_;
+    std::shared_ptr<const std::string> ext_;
+    size_t extPos_ = 0;     // ext_ 中已写出的字节数
+    int fileFd_ = -1;
+    off_t fileOff_ = 0;     // 下一次 sendfile 的起始偏移
+    size_t fileLeft_ = 0;
+    bool blocked_ = false;
+    bool peerClosed_ = false;
+    bool keepAlive_ = true;
+    bool rejecting_ = false;
+    bool deferred_ = false;
+    bool deferHead_ = false;        // 推迟的是 HEAD 请求
+    HttpResponse::Deferred deferWork_;
+    std::function<void()> deferDone_;
+    uint64_t timer_ = 0;
+    std::atomic<int64_t> lastActive_{0};
+    std::atomic<int64_t> requestStart_{0};
+};
@@ -0,0 +1,42 @@
+#include "epoller.h"
+#include <errno.h>
+#include <assert.h>
+#include <unistd.h>
+
+Epoller::Epoller(int maxEvent) : epollFd_(epoll_create1(EPOLL_CLOEXEC)), events_(maxEvent) {
+    assert(epollFd_ >= 0 && events_.size() > 0);
+}
+
+Epoller::~Epoller() {
+    close(epollFd_);
+}
+
+bool Epoller::addFd(int fd, uint32_t events, void* ptr) {
+    if(fd < 0) return false;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.ptr = ptr;
+    return 0 == epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+}
+
+bool Epoller::modFd(int fd, uint32_t events, void* ptr) {
+    if(fd < 0) return false;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.ptr = ptr;
+    return 0 == epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+}
+
+bool Epoller::delFd(int fd) {
+    if(fd < 0) return false;
+    epoll_event ev{};
+    return 0 == epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, &ev);
+}
+
+int Epoller::wait(int timeoutMs) {
+    int n = epoll_wait(epollFd_, &events_[0], static_cast<int>(events_.size()), timeoutMs);
+    if(n < 0 && errno == EINTR) {
+        return 0;
+    }
+    return n;
+}
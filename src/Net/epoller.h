@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <sys/epoll.h>
+
+// epoll 的简单封装，事件的用户数据统一使用 data.ptr
+class Epoller {
+public:
+    explicit Epoller(int maxEvent = 1024);
+    ~Epoller();
+
+    bool addFd(int fd, uint32_t events, void* ptr);
+    bool modFd(int fd, uint32_t events, void* ptr);
+    bool delFd(int fd);
+
+    // 返回就绪事件数，被信号打断时返回 0
+    int wait(int timeoutMs = -1);
+
+    void* getEventPtr(size_t i) const {
+        return events_[i].data.ptr;
+    }
+
+    uint32_t getEvents(size_t i) const {
+        return events_[i].events;
+    }
+
+private:
+    int epollFd_;
+    std::vector<struct epoll_event> events_;
+};
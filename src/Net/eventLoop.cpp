@@ -0,0 +1,232 @@
+#include "eventLoop.h"
+#include <algorithm>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "sockets.h"
+
+static char kListenTag;
+static char kWakeTag;
+
+// 连接只注册一次，读写事件都用边沿触发，不需要每次处理完重新激活
+static const uint32_t kConnEvents = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLRDHUP;
+// 连接超时是秒级的，粗粒度的 tick 让有连接时每秒只多醒来几次
+static const std::chrono::milliseconds kTimerTick(100);
+
+EventLoop::EventLoop(int port, int maxEvents, ThreadPool* pool, const HttpHandler* handler, OverloadControl* overload)
+    : port_(port), epoller_(maxEvents), pool_(pool), handler_(handler), overload_(overload),
+      wheel_(nullptr, kTimerTick) {
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoller_.addFd(wakeFd_, EPOLLIN | EPOLLET, &kWakeTag);
+}
+
+EventLoop::~EventLoop() {
+    for(auto& it : conns_) {
+        overload_->releaseConnection();
+        delete it.second;
+    }
+    conns_.clear();
+    if(listenFd_ >= 0) {
+        close(listenFd_);
+    }
+    close(wakeFd_);
+}
+
+bool EventLoop::init() {
+    listenFd_ = createListenFd(port_, true);
+    if(listenFd_ < 0) {
+        return false;
+    }
+    return epoller_.addFd(listenFd_, EPOLLIN | EPOLLET, &kListenTag);
+}
+
+void EventLoop::loop() {
+    while(!isClosed_ || deferring_ > 0) {
+        int n = epoller_.wait(wheel_.nextTimeoutMs());
+        if(n < 0) {
+            LOG_ERROR(INS()) << "epoll_wait error, errno " << errno << std::endl;
+            break;
+        }
+        wakeAt_ = ThreadPool::Clock::now();
+        for(int i = 0; i < n; ++i) {
+            void* ptr = epoller_.getEventPtr(i);
+            if(ptr == &kListenTag) {
+                handleAccept();
+            }
+            else if(ptr == &kWakeTag) {
+                uint64_t cnt;
+                while(read(wakeFd_, &cnt, sizeof(cnt)) > 0) {}
+                doPending();
+            }
+            else {
+                handleConn(static_cast<Connection*>(ptr), epoller_.getEvents(i));
+            }
+        }
+        wheel_.advance();
+    }
+}
+
+void EventLoop::stop() {
+    queueInLoop([this] { isClosed_ = true; });
+}
+
+void EventLoop::queueInLoop(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lck(pendingMtx_);
+        pending_.push_back(std::move(fn));
+    }
+    uint64_t one = 1;
+    ssize_t n = write(wakeFd_, &one, sizeof(one));
+    (void)n;
+}
+
+void EventLoop::doPending() {
+    std::vector<std::function<void()>> fns;
+    {
+        std::lock_guard<std::mutex> lck(pendingMtx_);
+        fns.swap(pending_);
+    }
+    for(auto& fn : fns) {
+        fn();
+    }
+}
+
+void EventLoop::handleAccept() {
+    while(true) {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int fd = accept4(listenFd_, (struct sockaddr*)&addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARN(INS()) << "accept error, errno " << errno << std::endl;
+            }
+            return;
+        }
+        if(!overload_->acquireConnection()) {
+            close(fd);
+            continue;
+        }
+        setNoDelay(fd);
+        Connection* conn = new Connection(fd, addr, ++nextId_, handler_);
+        conns_[fd] = conn;
+        connCount_.fetch_add(1, std::memory_order_relaxed);
+        if(!epoller_.addFd(fd, kConnEvents, conn)) {
+            closeConn(conn);
+            continue;
+        }
+        armTimer(conn, overload_->firstCheckMs());
+    }
+}
+
+void EventLoop::armTimer(Connection* conn, int delayMs) {
+    if(delayMs < 0) {
+        return;
+    }
+    conn->setTimer(wheel_.schedule(std::chrono::milliseconds(delayMs), [this, conn] { onTimer(conn); }));
+}
+
+// 定时器在关闭连接时取消，回调执行时连接一定还在
+void EventLoop::onTimer(Connection* conn) {
+    conn->setTimer(0);
+    int left = overload_->checkTimeout(*conn, Connection::nowMs());
+    if(left == 0) {
+        closeConn(conn);
+        return;
+    }
+    armTimer(conn, left);
+}
+
+void EventLoop::handleConn(Connection* conn, uint32_t events) {
+    int saveErrno = 0;
+    if(events & EPOLLERR) {
+        closeConn(conn);
+        return;
+    }
+    if(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+        if(conn->read(&saveErrno) < 0) {
+            closeConn(conn);
+            return;
+        }
+        if(!conn->isRejecting() && overload_->shouldShed(queueDelay())) {
+            conn->setRejecting(true);
+        }
+        processConn(conn);
+    }
+    do {
+        if(conn->isBlocked()) {
+            processConn(conn);
+        }
+        if(conn->toWriteBytes() > 0) {
+            if(conn->write(&saveErrno) < 0) {
+                closeConn(conn);
+                return;
+            }
+            // 没写完等下一次 EPOLLOUT
+            if(conn->toWriteBytes() > 0) {
+                conn->touch(Connection::nowMs());
+                return;
+            }
+        }
+    } while(conn->isBlocked());
+    if(conn->isClosing()) {
+        closeConn(conn);
+        return;
+    }
+    conn->touch(Connection::nowMs());
+}
+
+ThreadPool::Clock::duration EventLoop::queueDelay() const {
+    ThreadPool::Clock::duration lag = ThreadPool::Clock::now() - wakeAt_;
+    if(pool_) {
+        lag = std::max(lag, pool_->queueDelay());
+    }
+    return lag;
+}
+
+void EventLoop::processConn(Connection* conn) {
+    conn->process();
+    std::function<void()> work = conn->takeDeferred();
+    if(!work) {
+        return;
+    }
+    if(!pool_) {
+        work();
+        conn->finishDeferred();
+        return;
+    }
+    ++deferring_;
+    pool_->addTask([this, conn, work] {
+        work();
+        queueInLoop([this, conn] { onDeferredDone(conn); });
+    });
+}
+
+void EventLoop::onDeferredDone(Connection* conn) {
+    --deferring_;
+    // 等待期间连接已被关闭，closeConn 把释放留到了这里
+    auto it = conns_.find(conn->getFd());
+    if(it == conns_.end() || it->second != conn) {
+        delete conn;
+        return;
+    }
+    conn->finishDeferred();
+    handleConn(conn, 0);
+}
+
+void EventLoop::closeConn(Connection* conn) {
+    if(conn->timer()) {
+        wheel_.cancel(conn->timer());
+    }
+    epoller_.delFd(conn->getFd());
+    conns_.erase(conn->getFd());
+    connCount_.fetch_sub(1, std::memory_order_relaxed);
+    overload_->releaseConnection();
+    // 推迟的响应还在线程池上生成，由 onDeferredDone 释放
+    if(!conn->isDeferred()) {
+        delete conn;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "epoller.h"
+#include "connection.h"
+#include "overload.h"
+#include "../Pool/timerWheel.hpp"
+#include "../Pool/threadPool.hpp"
+
+/**
+ * 多 Reactor 模式下的单个事件循环，一个线程一个循环
+ * 每个循环持有自己的 SO_REUSEPORT 监听 socket，由内核把新连接分散到各个循环
+ * 连接从 accept 到关闭都只在本循环线程上处理，读-处理-写直接内联执行，不跨线程、不加锁
+ * HttpHandler 在本循环线程上直接调用，不应阻塞；耗时的响应用 HttpResponse::defer() 交给线程池生成，
+ * 完成后经 queueInLoop 回到本循环线程发出
+ * 连接超时的定时器挂在本循环的 TimerWheel 上，由 epoll_wait 的超时驱动，回调也在本循环线程执行
+*/
+class EventLoop {
+public:
+    EventLoop(int port, int maxEvents, ThreadPool* pool, const HttpHandler* handler, OverloadControl* overload);
+    ~EventLoop();
+
+    bool init();
+    // 在调用线程上运行，直到 stop()
+    void loop();
+    // 可在任意线程调用
+    void stop();
+
+    size_t connectionCount() const {
+        return connCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // 把 fn 放到本循环线程上执行，可在任意线程调用
+    void queueInLoop(std::function<void()> fn);
+    void handleAccept();
+    void handleConn(Connection* conn, uint32_t events);
+    // conn->process()，遇到推迟的响应时交给线程池
+    void processConn(Connection* conn);
+    void onDeferredDone(Connection* conn);
+    // 接入控制用的排队延迟：本轮就绪事件从 epoll_wait 返回到现在的时间，与线程池排队时间取较大者
+    ThreadPool::Clock::duration queueDelay() const;
+    void doPending();
+    void armTimer(Connection* conn, int delayMs);
+    void onTimer(Connection* conn);
+    void closeConn(Connection* conn);
+
+    int port_;
+    int listenFd_ = -1;
+    int wakeFd_ = -1;
+    bool isClosed_ = false;
+    ThreadPool::Clock::time_point wakeAt_;     // 本轮 epoll_wait 返回的时间
+    int deferring_ = 0;     // 线程池上尚未回到本循环的推迟响应数，归零前 loop() 不退出
+    uint64_t nextId_ = 0;
+    Epoller epoller_;
+    ThreadPool* pool_;
+    const HttpHandler* handler_;
+    OverloadControl* overload_;
+    TimerWheel wheel_;
+
+    std::unordered_map<int, Connection*> conns_;   // 只在本循环线程访问
+    std::atomic<size_t> connCount_{0};
+
+    std::mutex pendingMtx_;
+    std::vector<std::function<void()>> pending_;
+};
@@ -0,0 +1,138 @@
+#include "ioUring.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* p) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, p));
+}
+
+static int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+IoUring::~IoUring() {
+    release();
+}
+
+void IoUring::release() {
+    int saveErrno = errno;
+    if(sqes_) {
+        munmap(sqes_, sqesLen_);
+    }
+    if(cqPtr_ && cqPtr_ != sqPtr_) {
+        munmap(cqPtr_, cqLen_);
+    }
+    if(sqPtr_) {
+        munmap(sqPtr_, sqLen_);
+    }
+    if(ringFd_ >= 0) {
+        close(ringFd_);
+    }
+    ringFd_ = -1;
+    sqPtr_ = cqPtr_ = nullptr;
+    sqes_ = nullptr;
+    sqLen_ = cqLen_ = sqesLen_ = 0;
+    sqeTail_ = toSubmit_ = 0;
+    errno = saveErrno;
+}
+
+bool IoUring::init(unsigned entries, unsigned cqEntries, unsigned flags) {
+    release();
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags = flags;
+    if(cqEntries > 0) {
+        p.flags |= IORING_SETUP_CQSIZE;
+        p.cq_entries = cqEntries;
+    }
+    ringFd_ = ioUringSetup(entries, &p);
+    if(ringFd_ < 0) {
+        return false;
+    }
+
+    sqLen_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cqLen_ = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+    if(single && cqLen_ > sqLen_) {
+        sqLen_ = cqLen_;
+    }
+    sqPtr_ = mmap(nullptr, sqLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    if(sqPtr_ == MAP_FAILED) {
+        sqPtr_ = nullptr;
+        release();
+        return false;
+    }
+    if(single) {
+        cqPtr_ = sqPtr_;
+    }
+    else {
+        cqPtr_ = mmap(nullptr, cqLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+        if(cqPtr_ == MAP_FAILED) {
+            cqPtr_ = nullptr;
+            release();
+            return false;
+        }
+    }
+    sqesLen_ = p.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(nullptr, sqesLen_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+    if(sqes == MAP_FAILED) {
+        release();
+        return false;
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(sqPtr_);
+    sqHead_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+    sqEntries_ = p.sq_entries;
+    sqeTail_ = *sqTail_;
+    // 提交项与数组下标一一对应，之后不再改动
+    unsigned* array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+    for(unsigned i = 0; i < sqEntries_; ++i) {
+        array[i] = i;
+    }
+
+    char* cq = static_cast<char*>(cqPtr_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + p.cq_off.cqes);
+    return true;
+}
+
+struct io_uring_sqe* IoUring::getSqe() {
+    unsigned head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+    if(sqeTail_ - head >= sqEntries_) {
+        submitAndWait(0);
+        head = __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+        if(sqeTail_ - head >= sqEntries_) {
+            return nullptr;
+        }
+    }
+    struct io_uring_sqe* sqe = &sqes_[sqeTail_ & sqMask_];
+    memset(sqe, 0, sizeof(*sqe));
+    ++sqeTail_;
+    ++toSubmit_;
+    return sqe;
+}
+
+int IoUring::submitAndWait(unsigned waitNr) {
+    __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+    unsigned flags = waitNr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int ret;
+    do {
+        ret = ioUringEnter(ringFd_, toSubmit_, waitNr, flags);
+    } while(ret < 0 && errno == EINTR);
+    if(ret >= 0) {
+        toSubmit_ -= ret < static_cast<int>(toSubmit_) ? ret : toSubmit_;
+    }
+    return ret;
+}
+
+int IoUring::registerOp(unsigned opcode, const void* arg, unsigned nrArgs) {
+    return static_cast<int>(syscall(__NR_io_uring_register, ringFd_, opcode, arg, nrArgs));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+
+/**
+ * io_uring 的最小封装，直接使用系统调用，不依赖 liburing
+ * 只能在一个线程中使用：getSqe() 填好的请求在下一次 submitAndWait() 时一起提交
+*/
+class IoUring {
+public:
+    IoUring() = default;
+    ~IoUring();
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    // 创建环并映射共享内存，失败返回 false 并保留 errno；失败后可以换参数再次调用
+    bool init(unsigned entries, unsigned cqEntries, unsigned flags);
+
+    // 取一个空闲的提交项并清零；提交队列已满时先把已有的提交出去，仍然满（如完成队列溢出时内核拒绝提交）返回 nullptr
+    struct io_uring_sqe* getSqe();
+
+    // 提交所有未提交的请求，并等待至少 waitNr 个完成事件
+    int submitAndWait(unsigned waitNr);
+
+    // 依次把完成队列中的事件交给 fn，返回处理的个数
+    template<class F>
+    unsigned forEachCqe(F&& fn) {
+        unsigned head = *cqHead_;
+        unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+        unsigned count = tail - head;
+        for(; head != tail; ++head) {
+            fn(cqes_[head & cqMask_]);
+        }
+        __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    int registerOp(unsigned opcode, const void* arg, unsigned nrArgs);
+
+    int fd() const {
+        return ringFd_;
+    }
+
+private:
+    // 解除映射并关闭环，回到未初始化状态，不改变 errno
+    void release();
+
+    int ringFd_ = -1;
+    void* sqPtr_ = nullptr;
+    void* cqPtr_ = nullptr;
+    size_t sqLen_ = 0;
+    size_t cqLen_ = 0;
+    struct io_uring_sqe* sqes_ = nullptr;
+    size_t sqesLen_ = 0;
+
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned sqEntries_ = 0;
+    unsigned sqeTail_ = 0;      // 本地填写位置，提交时发布到 sqTail_
+    unsigned toSubmit_ = 0;
+
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    struct io_uring_cqe* cqes_ = nullptr;
+};
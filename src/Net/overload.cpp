@@ -0,0 +1,131 @@
+#include "overload.h"
+#include <chrono>
+#include "yaml-cpp/yaml.h"
+
+OverloadControl::Config OverloadControl::Config::loadFile(const std::string& path) {
+    try {
+        YAML::Node root = YAML::LoadFile(path);
+        return fromYaml(root["overload"]);
+    }
+    catch(const YAML::Exception& e) {
+        LOG_ERROR(INS()) << "load overload config " << path << " failed: " << e.what() << std::endl;
+    }
+    return Config();
+}
+
+OverloadControl::Config OverloadControl::Config::fromYaml(const YAML::Node& node) {
+    Config config;
+    if(!node.IsDefined() || !node.IsMap()) {
+        return config;
+    }
+    if(node["maxConnections"].IsDefined()) {
+        config.maxConnections = node["maxConnections"].as<size_t>();
+    }
+    if(node["idleTimeoutMs"].IsDefined()) {
+        config.idleTimeoutMs = node["idleTimeoutMs"].as<int>();
+    }
+    if(node["requestTimeoutMs"].IsDefined()) {
+        config.requestTimeoutMs = node["requestTimeoutMs"].as<int>();
+    }
+    if(node["queueDelayMs"].IsDefined()) {
+        config.queueDelayMs = node["queueDelayMs"].as<int>();
+    }
+    return config;
+}
+
+OverloadControl::OverloadControl(const Config& config)
+    : config_(config), queueTarget_(std::chrono::milliseconds(config.queueDelayMs)) {
+}
+
+bool OverloadControl::acquireConnection() {
+    size_t count = connections_.fetch_add(1, std::memory_order_relaxed);
+    if(config_.maxConnections > 0 && count >= config_.maxConnections) {
+        connections_.fetch_sub(1, std::memory_order_relaxed);
+        rejectedConns_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void OverloadControl::releaseConnection() {
+    connections_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool OverloadControl::shouldShed(ThreadPool::Clock::duration delay) {
+    if(config_.queueDelayMs <= 0) {
+        return false;
+    }
+    bool over = delay > queueTarget_;
+    // 只有切换状态的那个线程写日志
+    if(over != shedding_.load(std::memory_order_relaxed) && shedding_.exchange(over) != over) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(delay).count();
+        if(over) {
+            LOG_WARN(INS()) << "overload: queue delay " << us << "us exceeds "
+                            << config_.queueDelayMs << "ms, rejecting new requests with 503" << std::endl;
+        }
+        else {
+            LOG_WARN(INS()) << "overload: queue delay back to " << us
+                            << "us, admitting new requests" << std::endl;
+        }
+    }
+    if(over) {
+        shedConns_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return over;
+}
+
+int OverloadControl::firstCheckMs() const {
+    int idle = config_.idleTimeoutMs;
+    int request = config_.requestTimeoutMs;
+    if(idle > 0 && request > 0) {
+        return idle < request ? idle : request;
+    }
+    if(idle > 0 || request > 0) {
+        return idle > 0 ? idle : request;
+    }
+    return -1;
+}
+
+int OverloadControl::checkTimeout(const Connection& conn, int64_t now) {
+    int idle = config_.idleTimeoutMs;
+    int request = config_.requestTimeoutMs;
+    int64_t start = conn.requestStart();
+    if(start > 0 && request > 0) {
+        int64_t left = start + request - now;
+        if(left <= 0) {
+            requestTimeouts_.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        return static_cast<int>(left);
+    }
+    if(idle > 0) {
+        int64_t left = conn.lastActive() + idle - now;
+        if(left <= 0) {
+            idleTimeouts_.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        // 空闲期间随时可能开始新的请求，检查间隔不超过请求超时，请求超时至多晚一个周期发现
+        if(request > 0 && left > request) {
+            left = request;
+        }
+        return static_cast<int>(left);
+    }
+    return request > 0 ? request : -1;
+}
+
+OverloadControl::Stats OverloadControl::stats() const {
+    Stats s;
+    s.connections = connections_.load(std::memory_order_relaxed);
+    s.rejectedConns = rejectedConns_.load(std::memory_order_relaxed);
+    s.shedConns = shedConns_.load(std::memory_order_relaxed);
+    s.idleTimeouts = idleTimeouts_.load(std::memory_order_relaxed);
+    s.requestTimeouts = requestTimeouts_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void OverloadControl::logStats() {
+    Stats s = stats();
+    LOG_INFO(INS()) << "overload: connections " << s.connections << ", rejected connections " << s.rejectedConns
+                    << ", shed connections " << s.shedConns << ", idle timeouts " << s.idleTimeouts
+                    << ", request timeouts " << s.requestTimeouts << std::endl;
+}
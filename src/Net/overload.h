@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include "connection.h"
+#include "../Pool/threadPool.hpp"
+
+namespace YAML {
+class Node;
+}
+
+/**
+ * 过载保护，由 WebServer 持有，单 Reactor 与各个事件循环共用一份
+ * 连接数上限：已有 maxConnections 个连接时，新连接 accept 后立即关闭
+ * 超时：收到请求首字节后 requestTimeoutMs 内没有收齐，或连接 idleTimeoutMs 内没有任何读写，即关闭连接；
+ *       每个连接只挂一个定时器，到期时按连接当前的状态重新计算，未超时则按剩余时间重新挂上，读写时不必改动定时器
+ * 接入控制：排队延迟超过 queueDelayMs 时，新读到请求的连接不再处理，直接回 503 并关闭，
+ *           使已接入请求的延迟保持稳定；开始和停止拒绝时各写一条 WARN
+ *           单 Reactor 模式下排队延迟为线程池队首任务的等待时间；多 Reactor 模式下请求在循环线程上内联处理，
+ *           取事件循环的滞后（本轮就绪事件从唤醒到处理已等待的时间）与线程池上推迟响应的等待时间中较大者
+ *
+ * 配置可以放在同一个 YAML 文件中：
+ *   overload:
+ *     maxConnections: 10000   # 0 不限制
+ *     idleTimeoutMs: 60000    # 0 不检查
+ *     requestTimeoutMs: 10000 # 0 不检查
+ *     queueDelayMs: 100       # 0 关闭接入控制
+*/
+class OverloadControl {
+public:
+    struct Config {
+        size_t maxConnections = 0;
+        int idleTimeoutMs = 60000;
+        int requestTimeoutMs = 10000;
+        int queueDelayMs = 100;
+
+        // 读取 YAML 文件中的 overload 节点，文件或节点不存在时返回默认配置
+        static Config loadFile(const std::string& path);
+        static Config fromYaml(const YAML::Node& node);
+    };
+
+    struct Stats {
+        size_t connections;
+        uint64_t rejectedConns;     // 超过连接数上限被关闭的新连接
+        uint64_t shedConns;         // 因排队过久改为回 503 的连接
+        uint64_t idleTimeouts;
+        uint64_t requestTimeouts;
+    };
+
+    explicit OverloadControl(const Config& config);
+
+    const Config& config() const {
+        return config_;
+    }
+
+    // 新连接占用一个名额，已满时返回 false 并计数，调用者应直接关闭连接
+    bool acquireConnection();
+    void releaseConnection();
+
+    // 排队延迟超过目标时返回 true 并计数，调用者应把连接置为拒绝状态
+    bool shouldShed(ThreadPool::Clock::duration delay);
+    bool shouldShed(const ThreadPool& pool) {
+        return shouldShed(pool.queueDelay());
+    }
+
+    // 新连接第一次检查超时前的毫秒数，两种超时都关闭时返回 -1
+    int firstCheckMs() const;
+    // 已超时返回 0 并计数，调用者应关闭连接；否则返回下次检查前的毫秒数，-1 表示不再检查
+    int checkTimeout(const Connection& conn, int64_t now);
+
+    Stats stats() const;
+    void logStats();
+
+private:
+    Config config_;
+    ThreadPool::Clock::duration queueTarget_;
+    std::atomic<size_t> connections_{0};
+    std::atomic<uint64_t> rejectedConns_{0};
+    std::atomic<uint64_t> shedConns_{0};
+    std::atomic<uint64_t> idleTimeouts_{0};
+    std::atomic<uint64_t> requestTimeouts_{0};
+    std::atomic<bool> shedding_{false};
+};
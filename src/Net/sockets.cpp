@@ -0,0 +1,44 @@
+#include "sockets.h"
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "../Log/log.h"
+
+int createListenFd(int port, bool reusePort) {
+    if(port > 65535 || port < 1024) {
+        LOG_ERROR(INS()) << "port " << port << " error!" << std::endl;
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0) {
+        LOG_ERROR(INS()) << "create socket error, errno " << errno << std::endl;
+        return -1;
+    }
+    int optval = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
+    if(reusePort && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
+        LOG_ERROR(INS()) << "set SO_REUSEPORT error, errno " << errno << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if(bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        LOG_ERROR(INS()) << "bind/listen port " << port << " error, errno " << errno << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void setNoDelay(int fd) {
+    int optval = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));
+}
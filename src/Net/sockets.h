@@ -0,0 +1,7 @@
+#pragma once
+
+// 创建非阻塞的监听 socket；reusePort 为 true 时设置 SO_REUSEPORT，多个 socket 可监听同一端口
+// 失败返回 -1
+int createListenFd(int port, bool reusePort);
+
+void setNoDelay(int fd);
@@ -0,0 +1,498 @@
+#include "uringLoop.h"
+#include <algorithm>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include "sockets.h"
+#include "../MemoryPool/ConcurrentAlloc.hpp"
+
+// TIMEOUT 请求的周期，也是时间轮的 tick
+static const std::chrono::milliseconds kTimerTick(100);
+
+UringLoop::UringLoop(int port, int entries, ThreadPool* pool, const HttpHandler* handler, OverloadControl* overload)
+    : port_(port), entries_(entries), pool_(pool), handler_(handler), overload_(overload),
+      wheel_(nullptr, kTimerTick) {
+    tick_.tv_sec = 0;
+    tick_.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(kTimerTick).count();
+}
+
+UringLoop::~UringLoop() {
+    for(Peer* p : peers_) {
+        overload_->releaseConnection();
+        delete p->conn;
+        delete p;
+    }
+    peers_.clear();
+    if(bufRing_) {
+        munmap(bufRing_, bufRingLen_);
+    }
+    for(char* buf : bufs_) {
+        ConcurrentFree(buf, kBufSize);
+    }
+    if(listenFd_ >= 0) {
+        close(listenFd_);
+    }
+    if(wakeFd_ >= 0) {
+        close(wakeFd_);
+    }
+}
+
+bool UringLoop::init() {
+    // 单提交者限定为调用 init() 的线程，即循环线程
+    unsigned flags = IORING_SETUP_SINGLE_ISSUER;
+    if(!ring_.init(entries_, entries_ * 4, flags | IORING_SETUP_DEFER_TASKRUN) &&
+       !ring_.init(entries_, entries_ * 4, flags | IORING_SETUP_COOP_TASKRUN)) {
+        LOG_WARN(INS()) << "io_uring setup failed, errno " << errno << std::endl;
+        return false;
+    }
+
+    bufRingLen_ = kBufCount * sizeof(struct io_uring_buf);
+    void* ring = mmap(nullptr, bufRingLen_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(ring == MAP_FAILED) {
+        return false;
+    }
+    bufRing_ = static_cast<struct io_uring_buf_ring*>(ring);
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(bufRing_);
+    reg.ring_entries = kBufCount;
+    reg.bgid = kBufGroup;
+    if(ring_.registerOp(IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        LOG_WARN(INS()) << "io_uring register buffer ring failed, errno " << errno << std::endl;
+        return false;
+    }
+    bufs_.reserve(kBufCount);
+    for(unsigned i = 0; i < kBufCount; ++i) {
+        bufs_.push_back(static_cast<char*>(ConcurrentAlloc(kBufSize)));
+        recycleBuffer(static_cast<uint16_t>(i));
+    }
+
+    wakeFd_ = eventfd(0, EFD_CLOEXEC);
+    listenFd_ = createListenFd(port_, true);
+    return wakeFd_ >= 0 && listenFd_ >= 0;
+}
+
+void UringLoop::loop() {
+    armAccept();
+    armWake();
+    if(overload_->firstCheckMs() >= 0) {
+        armTick();
+    }
+    while(!isClosed_ || inflight_ > 0) {
+        if(ring_.submitAndWait(1) < 0 && errno != EAGAIN && errno != EBUSY && errno != EINTR) {
+            LOG_ERROR(INS()) << "io_uring_enter error, errno " << errno << std::endl;
+            break;
+        }
+        wakeAt_ = ThreadPool::Clock::now();
+        ring_.forEachCqe([this](const struct io_uring_cqe& cqe) { handleCqe(cqe); });
+        if(retry_) {
+            retryPending();
+        }
+    }
+}
+
+void UringLoop::stop() {
+    queueInLoop([this] { isClosed_ = true; });
+}
+
+void UringLoop::queueInLoop(std::function<void()> fn) {
+    {
+        std::lock_guard<std::mutex> lck(pendingMtx_);
+        pending_.push_back(std::move(fn));
+    }
+    uint64_t one = 1;
+    ssize_t n = write(wakeFd_, &one, sizeof(one));
+    (void)n;
+}
+
+void UringLoop::doPending() {
+    std::vector<std::function<void()>> fns;
+    {
+        std::lock_guard<std::mutex> lck(pendingMtx_);
+        fns.swap(pending_);
+    }
+    for(auto& fn : fns) {
+        fn();
+    }
+}
+
+// user_data 的低 3 位是操作类型，其余是 Peer 地址
+struct io_uring_sqe* UringLoop::getSqe(void* ptr, Op op) {
+    struct io_uring_sqe* sqe = ring_.getSqe();
+    if(sqe == nullptr) {
+        LOG_WARN(INS()) << "io_uring submission queue full, errno " << errno << std::endl;
+        return nullptr;
+    }
+    sqe->user_data = reinterpret_cast<uint64_t>(ptr) | op;
+    ++inflight_;
+    return sqe;
+}
+
+void UringLoop::armAccept() {
+    struct io_uring_sqe* sqe = getSqe(nullptr, OP_ACCEPT);
+    if(sqe == nullptr) {
+        retry_ |= RETRY_ACCEPT;
+        return;
+    }
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenFd_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+}
+
+void UringLoop::armWake() {
+    struct io_uring_sqe* sqe = getSqe(nullptr, OP_WAKE);
+    if(sqe == nullptr) {
+        retry_ |= RETRY_WAKE;
+        return;
+    }
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wakeFd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wakeBuf_);
+    sqe->len = sizeof(wakeBuf_);
+}
+
+bool UringLoop::armRecv(Peer* p) {
+    struct io_uring_sqe* sqe = getSqe(p, OP_RECV);
+    if(sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = p->conn->getFd();
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufGroup;
+    p->recving = true;
+    return true;
+}
+
+void UringLoop::armTick() {
+    struct io_uring_sqe* sqe = getSqe(nullptr, OP_TICK);
+    if(sqe == nullptr) {
+        retry_ |= RETRY_TICK;
+        return;
+    }
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = reinterpret_cast<uint64_t>(&tick_);
+    sqe->len = 1;
+}
+
+void UringLoop::armTimer(Peer* p, int delayMs) {
+    if(delayMs < 0) {
+        return;
+    }
+    p->conn->setTimer(wheel_.schedule(std::chrono::milliseconds(delayMs), [this, p] { onTimer(p); }));
+}
+
+// 定时器在释放 Peer 时取消，回调执行时 Peer 一定还在
+void UringLoop::onTimer(Peer* p) {
+    p->conn->setTimer(0);
+    if(p->closing) {
+        return;
+    }
+    int left = overload_->checkTimeout(*p->conn, Connection::nowMs());
+    if(left == 0) {
+        closePeer(p);
+        return;
+    }
+    armTimer(p, left);
+}
+
+// 缓冲环的第 0 项与 tail 字段重叠；内核头文件中的柔性数组在 C++ 下多出 8 字节偏移，不能用 bufs[] 访问
+void UringLoop::recycleBuffer(uint16_t bid) {
+    struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(bufRing_) + (bufTail_ & (kBufCount - 1));
+    buf->addr = reinterpret_cast<uint64_t>(bufs_[bid]);
+    buf->len = kBufSize;
+    buf->bid = bid;
+    ++bufTail_;
+    __atomic_store_n(&bufRing_->tail, bufTail_, __ATOMIC_RELEASE);
+}
+
+void UringLoop::handleCqe(const struct io_uring_cqe& cqe) {
+    if(!(cqe.flags & IORING_CQE_F_MORE)) {
+        --inflight_;
+    }
+    Op op = static_cast<Op>(cqe.user_data & 7);
+    Peer* p = reinterpret_cast<Peer*>(cqe.user_data & ~static_cast<uint64_t>(7));
+    switch(op) {
+        case OP_ACCEPT:
+            onAccept(cqe.res, cqe.flags);
+            break;
+        case OP_WAKE: {
+            bool wasClosed = isClosed_;
+            doPending();
+            if(isClosed_ && !wasClosed) {
+                beginShutdown();
+            }
+            // 推迟的响应经 queueInLoop 回来，停止后也要等它们全部回来
+            if(!isClosed_ || deferring_ > 0) {
+                armWake();
+            }
+            break;
+        }
+        case OP_RECV:
+            onRecv(p, cqe.res, cqe.flags);
+            break;
+        case OP_SEND:
+            onSend(p, cqe.res);
+            break;
+        case OP_POLL:
+            p->polling = false;
+            if(p->closing) {
+                releaseIfIdle(p);
+            }
+            else {
+                flush(p);
+            }
+            break;
+        case OP_TICK:
+            wheel_.advance();
+            if(!isClosed_) {
+                armTick();
+            }
+            break;
+        case OP_CANCEL:
+            break;
+    }
+}
+
+void UringLoop::onAccept(int res, uint32_t flags) {
+    if(!(flags & IORING_CQE_F_MORE) && !isClosed_) {
+        armAccept();
+    }
+    if(res < 0) {
+        if(res != -ECANCELED) {
+            LOG_WARN(INS()) << "accept error, errno " << -res << std::endl;
+        }
+        return;
+    }
+    if(isClosed_ || !overload_->acquireConnection()) {
+        close(res);
+        return;
+    }
+    // 多次触发的 accept 不能带回对端地址，另行查询
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    getpeername(res, (struct sockaddr*)&addr, &len);
+    setNoDelay(res);
+    Peer* p = new Peer;
+    p->conn = new Connection(res, addr, ++nextId_, handler_);
+    peers_.insert(p);
+    connCount_.fetch_add(1, std::memory_order_relaxed);
+    if(!armRecv(p)) {
+        closePeer(p);
+        return;
+    }
+    armTimer(p, overload_->firstCheckMs());
+}
+
+void UringLoop::onRecv(Peer* p, int res, uint32_t flags) {
+    if(!(flags & IORING_CQE_F_MORE)) {
+        p->recving = false;
+    }
+    if(res > 0 && (flags & IORING_CQE_F_BUFFER)) {
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        if(!p->closing) {
+            p->conn->appendInput(bufs_[bid], res);
+        }
+        recycleBuffer(bid);
+    }
+    if(p->closing) {
+        releaseIfIdle(p);
+        return;
+    }
+    if(res == 0) {
+        p->conn->setPeerClosed();
+    }
+    else if(res < 0 && res != -ENOBUFS) {
+        closePeer(p);
+        return;
+    }
+    // 提供缓冲耗尽等原因会让多次触发的 recv 结束，重新挂上
+    if(!p->recving && res != 0 && !armRecv(p)) {
+        closePeer(p);
+        return;
+    }
+    if(res > 0 && !p->conn->isRejecting() && overload_->shouldShed(queueDelay())) {
+        p->conn->setRejecting(true);
+    }
+    flush(p);
+}
+
+void UringLoop::onSend(Peer* p, int res) {
+    p->sending = false;
+    if(p->closing) {
+        releaseIfIdle(p);
+        return;
+    }
+    if(res < 0) {
+        closePeer(p);
+        return;
+    }
+    p->conn->retrieveOutput(res);
+    flush(p);
+}
+
+void UringLoop::flush(Peer* p) {
+    Connection* conn = p->conn;
+    while(!p->sending && !p->polling) {
+        if(p->deferReady) {
+            p->deferReady = false;
+            conn->finishDeferred();
+        }
+        conn->process();
+        if(conn->isDeferred()) {
+            startDeferred(p);
+        }
+        int cnt = conn->pendingIov(p->iov);
+        if(cnt > 0) {
+            size_t len = 0;
+            for(int i = 0; i < cnt; ++i) {
+                len += p->iov[i].iov_len;
+            }
+            memset(&p->msg, 0, sizeof(p->msg));
+            p->msg.msg_iov = p->iov;
+            p->msg.msg_iovlen = cnt;
+            struct io_uring_sqe* sqe = getSqe(p, OP_SEND);
+            if(sqe == nullptr) {
+                closePeer(p);
+                return;
+            }
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = conn->getFd();
+            sqe->addr = reinterpret_cast<uint64_t>(&p->msg);
+            sqe->len = 1;
+            // 后面还有文件段时带 MSG_MORE，响应头与文件开头合并成满的报文发出
+            sqe->msg_flags = MSG_NOSIGNAL | (conn->toWriteBytes() > len ? MSG_MORE : 0);
+            p->sending = true;
+            conn->touch(Connection::nowMs());
+            return;
+        }
+        if(conn->hasFilePending()) {
+            int saveErrno = 0;
+            if(conn->sendFile(&saveErrno) < 0) {
+                closePeer(p);
+                return;
+            }
+            if(conn->hasFilePending()) {
+                struct io_uring_sqe* sqe = getSqe(p, OP_POLL);
+                if(sqe == nullptr) {
+                    closePeer(p);
+                    return;
+                }
+                sqe->opcode = IORING_OP_POLL_ADD;
+                sqe->fd = conn->getFd();
+                sqe->poll32_events = POLLOUT;
+                p->polling = true;
+                conn->touch(Connection::nowMs());
+                return;
+            }
+            continue;
+        }
+        if(!conn->isBlocked() && !p->deferReady) {
+            break;
+        }
+    }
+    if(!p->sending && !p->polling && conn->isClosing()) {
+        closePeer(p);
+        return;
+    }
+    conn->touch(Connection::nowMs());
+}
+
+ThreadPool::Clock::duration UringLoop::queueDelay() const {
+    ThreadPool::Clock::duration lag = ThreadPool::Clock::now() - wakeAt_;
+    if(pool_) {
+        lag = std::max(lag, pool_->queueDelay());
+    }
+    return lag;
+}
+
+void UringLoop::startDeferred(Peer* p) {
+    std::function<void()> work = p->conn->takeDeferred();
+    if(!work) {
+        return;
+    }
+    if(!pool_) {
+        work();
+        p->deferReady = true;
+        return;
+    }
+    ++deferring_;
+    p->deferring = true;
+    pool_->addTask([this, p, work] {
+        work();
+        queueInLoop([this, p] { onDeferredDone(p); });
+    });
+}
+
+void UringLoop::onDeferredDone(Peer* p) {
+    --deferring_;
+    p->deferring = false;
+    if(p->closing) {
+        releaseIfIdle(p);
+        return;
+    }
+    p->deferReady = true;
+    flush(p);
+}
+
+void UringLoop::beginShutdown() {
+    cancelOp(OP_ACCEPT);
+    cancelOp(OP_TICK);
+    std::vector<Peer*> peers(peers_.begin(), peers_.end());
+    for(Peer* p : peers) {
+        closePeer(p);
+    }
+}
+
+void UringLoop::cancelOp(Op op) {
+    struct io_uring_sqe* sqe = getSqe(nullptr, OP_CANCEL);
+    if(sqe == nullptr) {
+        retry_ |= op == OP_ACCEPT ? RETRY_CANCEL_ACCEPT : RETRY_CANCEL_TICK;
+        return;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = static_cast<uint64_t>(op);
+}
+
+// 提交队列满时没能挂上的常驻请求，在下一轮收完完成事件、队列腾出空间后补上；停止后只补取消请求
+void UringLoop::retryPending() {
+    unsigned retry = retry_;
+    retry_ = 0;
+    if(!isClosed_) {
+        if(retry & RETRY_ACCEPT) armAccept();
+        if(retry & RETRY_WAKE) armWake();
+        if(retry & RETRY_TICK) armTick();
+    }
+    if(retry & RETRY_CANCEL_ACCEPT) cancelOp(OP_ACCEPT);
+    if(retry & RETRY_CANCEL_TICK) cancelOp(OP_TICK);
+}
+
+// shutdown 让在途的 recv、发送和 poll 都尽快完成，全部完成后才释放，避免完成事件指向已释放的对象
+void UringLoop::closePeer(Peer* p) {
+    if(p->closing) {
+        return;
+    }
+    p->closing = true;
+    shutdown(p->conn->getFd(), SHUT_RDWR);
+    releaseIfIdle(p);
+}
+
+void UringLoop::releaseIfIdle(Peer* p) {
+    if(!p->closing || p->recving || p->sending || p->polling || p->deferring) {
+        return;
+    }
+    if(p->conn->timer()) {
+        wheel_.cancel(p->conn->timer());
+    }
+    peers_.erase(p);
+    connCount_.fetch_sub(1, std::memory_order_relaxed);
+    overload_->releaseConnection();
+    delete p->conn;
+    delete p;
+}
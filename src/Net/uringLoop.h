@@ -0,0 +1,129 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <sys/socket.h>
+#include "ioUring.h"
+#include "connection.h"
+#include "overload.h"
+#include "../Pool/timerWheel.hpp"
+#include "../Pool/threadPool.hpp"
+
+/**
+ * 多 Reactor 模式下基于 io_uring 的事件循环，与 EventLoop 接口相同，可互相替换
+ * 监听 socket 上挂一个多次触发的 accept，每个连接挂一个多次触发的 recv，
+ * 数据收进内核从提供缓冲环中挑选的缓冲，拷进连接的输入缓冲后立即归还；缓冲本身来自内存池
+ * 一轮完成事件处理完后，本轮产生的所有发送请求与下一次等待合并为一次 io_uring_enter
+ * 每个连接同一时刻至多一个发送在途，在途期间输出缓冲不动，新到的请求留在输入缓冲里等发送完成再处理
+ * 文件段直接调用非阻塞 sendfile，写不动时提交 POLL_ADD 等可写后继续
+ * HttpResponse::defer() 推迟的响应在线程池上生成，经 queueInLoop 回到本循环，等在途发送完成后再放入输出
+ * 连接超时的定时器挂在本循环的 TimerWheel 上，由一个周期性重新提交的 TIMEOUT 请求驱动
+ * 需要 6.0 以上内核，init() 失败时调用者应回退到 EventLoop；
+ * 环以 SINGLE_ISSUER 创建，只有创建它的线程能提交，init() 与 loop() 须在同一线程上调用
+*/
+class UringLoop {
+public:
+    UringLoop(int port, int entries, ThreadPool* pool, const HttpHandler* handler, OverloadControl* overload);
+    ~UringLoop();
+
+    // 在将要运行 loop() 的线程上调用，失败表示内核不支持
+    bool init();
+    // 在调用线程上运行，直到 stop()
+    void loop();
+    // 可在任意线程调用
+    void stop();
+
+    size_t connectionCount() const {
+        return connCount_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // 把 fn 放到本循环线程上执行，可在任意线程调用
+    void queueInLoop(std::function<void()> fn);
+    // 一个连接在 io_uring 上的状态，地址作为 user_data
+    struct Peer {
+        Connection* conn;
+        bool recving = false;
+        bool sending = false;
+        bool polling = false;
+        bool closing = false;
+        bool deferring = false;     // 推迟的响应正在线程池上生成
+        bool deferReady = false;    // 已生成，等没有在途发送时放入输出
+        struct iovec iov[2];
+        struct msghdr msg;
+    };
+
+    enum Op : uint64_t { OP_ACCEPT = 1, OP_WAKE, OP_RECV, OP_SEND, OP_POLL, OP_CANCEL, OP_TICK };
+    // 因提交队列满而没能提交、需要稍后补上的请求
+    enum Retry : unsigned {
+        RETRY_ACCEPT = 1,
+        RETRY_WAKE = 2,
+        RETRY_TICK = 4,
+        RETRY_CANCEL_ACCEPT = 8,
+        RETRY_CANCEL_TICK = 16,
+    };
+
+    static const unsigned kBufCount = 1024;     // 提供缓冲个数，2 的幂
+    static const unsigned kBufSize = 4096;
+    static const uint16_t kBufGroup = 0;
+
+    // 提交队列已满且无法提交时返回 nullptr：连接上的请求失败则关闭连接，常驻请求记入 retry_ 稍后补上
+    struct io_uring_sqe* getSqe(void* ptr, Op op);
+    void armAccept();
+    void armWake();
+    bool armRecv(Peer* p);
+    void armTick();
+    void cancelOp(Op op);
+    void retryPending();
+    void armTimer(Peer* p, int delayMs);
+    void onTimer(Peer* p);
+    void handleCqe(const struct io_uring_cqe& cqe);
+    void onAccept(int res, uint32_t flags);
+    void onRecv(Peer* p, int res, uint32_t flags);
+    void onSend(Peer* p, int res);
+    // 处理输入并发出输出，直到有请求在途或没有更多工作
+    void flush(Peer* p);
+    // 把连接上推迟的响应交给线程池
+    void startDeferred(Peer* p);
+    void onDeferredDone(Peer* p);
+    // 接入控制用的排队延迟：本轮完成事件从 io_uring_enter 返回到现在的时间，与线程池排队时间取较大者
+    ThreadPool::Clock::duration queueDelay() const;
+    void beginShutdown();
+    void closePeer(Peer* p);
+    void releaseIfIdle(Peer* p);
+    void recycleBuffer(uint16_t bid);
+    void doPending();
+
+    int port_;
+    int entries_;
+    int listenFd_ = -1;
+    int wakeFd_ = -1;
+    uint64_t wakeBuf_ = 0;
+    bool isClosed_ = false;
+    uint64_t nextId_ = 0;
+    int inflight_ = 0;          // 尚未收到最后一个完成事件的请求数
+    ThreadPool::Clock::time_point wakeAt_;     // 本轮 io_uring_enter 返回的时间
+    int deferring_ = 0;         // 线程池上尚未回到本循环的推迟响应数，归零前停止时也保持 wakeFd_ 上的读
+    unsigned retry_ = 0;        // Retry 位掩码
+    IoUring ring_;
+    ThreadPool* pool_;
+    const HttpHandler* handler_;
+    OverloadControl* overload_;
+    TimerWheel wheel_;
+    struct __kernel_timespec tick_;
+
+    struct io_uring_buf_ring* bufRing_ = nullptr;
+    size_t bufRingLen_ = 0;
+    uint16_t bufTail_ = 0;
+    std::vector<char*> bufs_;
+
+    std::unordered_set<Peer*> peers_;   // 只在本循环线程访问
+    std::atomic<size_t> connCount_{0};
+
+    std::mutex pendingMtx_;
+    std::vector<std::function<void()>> pending_;
+};
@@ -0,0 +1,333 @@
+#include "webServer.h"
+#include <future>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "sockets.h"
+
+// 监听 fd 与唤醒 fd 在 epoll 中的标记，连接使用 Connection* 本身
+static char kListenTag;
+static char kWakeTag;
+
+// 与 EventLoop 相同的 tick
+static const std::chrono::milliseconds kTimerTick(100);
+
+WebServer::WebServer(const Config& config)
+    : config_(config), epoller_(config.maxEvents), pool_(config.pool), overload_(config.overload),
+      wheel_(nullptr, kTimerTick) {
+    signal(SIGPIPE, SIG_IGN);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoller_.addFd(wakeFd_, EPOLLIN, &kWakeTag);
+    if(config_.loops == 0 && !initListen()) {
+        isClosed_ = true;
+    }
+}
+
+WebServer::~WebServer() {
+    // 等待已投递的事件处理完，再释放剩余连接
+    while(inflight_.load() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::lock_guard<std::mutex> lck(connMtx_);
+    for(auto& it : conns_) {
+        overload_.releaseConnection();
+        delete it.second;
+    }
+    conns_.clear();
+    if(listenFd_ >= 0) {
+        close(listenFd_);
+    }
+    close(wakeFd_);
+}
+
+bool WebServer::initListen() {
+    listenFd_ = createListenFd(config_.port, false);
+    if(listenFd_ < 0) {
+        return false;
+    }
+    if(!epoller_.addFd(listenFd_, EPOLLIN | EPOLLET, &kListenTag)) {
+        LOG_ERROR(INS()) << "add listen fd error!" << std::endl;
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    LOG_INFO(INS()) << "server listen on port " << config_.port << std::endl;
+    return true;
+}
+
+void WebServer::start() {
+    if(config_.statsIntervalMs > 0) {
+        std::chrono::milliseconds interval(config_.statsIntervalMs);
+        wheel_.schedulePeriodic(interval, interval, [this] { logStats(); });
+    }
+    if(config_.loops > 0) {
+        runLoops();
+        logStats();
+        return;
+    }
+    while(!isClosed_) {
+        int n = epoller_.wait(wheel_.nextTimeoutMs());
+        if(n < 0) {
+            LOG_ERROR(INS()) << "epoll_wait error, errno " << errno << std::endl;
+            break;
+        }
+        for(int i = 0; i < n; ++i) {
+            void* ptr = epoller_.getEventPtr(i);
+            if(ptr == &kListenTag) {
+                handleAccept();
+            }
+            else if(ptr == &kWakeTag) {
+                isClosed_ = true;
+            }
+            else {
+                dispatch(static_cast<Connection*>(ptr), epoller_.getEvents(i));
+            }
+        }
+        wheel_.advance();
+    }
+    LOG_INFO(INS()) << "server stopped" << std::endl;
+    logStats();
+}
+
+void WebServer::logStats() {
+    pool_.logStats();
+    overload_.logStats();
+}
+
+// io_uring 环只允许创建它的线程提交，因此 init() 在各自的循环线程上执行；
+// 全部初始化成功后才开始运行，任一失败则全部退出并返回 false
+bool WebServer::startUringLoops() {
+    std::vector<std::promise<bool>> ready(config_.loops);
+    std::vector<std::future<bool>> inited;
+    std::promise<bool> start;
+    std::shared_future<bool> go = start.get_future().share();
+    for(int i = 0; i < config_.loops; ++i) {
+        uringLoops_.emplace_back(new UringLoop(config_.port, config_.maxEvents, &pool_, &config_.handler, &overload_));
+        inited.push_back(ready[i].get_future());
+    }
+    for(int i = 0; i < config_.loops; ++i) {
+        loopThreads_.emplace_back([this, i, &ready, go] {
+            ThreadPool::pinToCpu(config_.loopCpus, i);
+            ready[i].set_value(uringLoops_[i]->init());
+            if(go.get()) {
+                uringLoops_[i]->loop();
+            }
+        });
+    }
+    bool ok = true;
+    for(auto& f : inited) {
+        ok = f.get() && ok;
+    }
+    start.set_value(ok);
+    if(!ok) {
+        for(auto& t : loopThreads_) {
+            t.join();
+        }
+        loopThreads_.clear();
+        uringLoops_.clear();
+    }
+    return ok;
+}
+
+void WebServer::runLoops() {
+    if(config_.uring && !startUringLoops()) {
+        LOG_WARN(INS()) << "io_uring not supported, fall back to epoll" << std::endl;
+    }
+    if(uringLoops_.empty()) {
+        for(int i = 0; i < config_.loops; ++i) {
+            loops_.emplace_back(new EventLoop(config_.port, config_.maxEvents, &pool_, &config_.handler, &overload_));
+            if(!loops_.back()->init()) {
+                LOG_ERROR(INS()) << "init event loop " << i << " failed" << std::endl;
+                loops_.clear();
+                return;
+            }
+        }
+        for(int i = 0; i < config_.loops; ++i) {
+            loopThreads_.emplace_back([this, i] {
+                ThreadPool::pinToCpu(config_.loopCpus, i);
+                loops_[i]->loop();
+            });
+        }
+    }
+    LOG_INFO(INS()) << "server listen on port " << config_.port << " with " << config_.loops
+                    << (uringLoops_.empty() ? " epoll" : " io_uring") << " event loops" << std::endl;
+
+    // 主线程只等待 stop() 和推进定期输出计数的定时器
+    while(!isClosed_) {
+        int n = epoller_.wait(wheel_.nextTimeoutMs());
+        for(int i = 0; i < n; ++i) {
+            if(epoller_.getEventPtr(i) == &kWakeTag) {
+                isClosed_ = true;
+            }
+        }
+        wheel_.advance();
+    }
+    for(auto& loop : loops_) {
+        loop->stop();
+    }
+    for(auto& loop : uringLoops_) {
+        loop->stop();
+    }
+    for(auto& t : loopThreads_) {
+        t.join();
+    }
+    loopThreads_.clear();
+    loops_.clear();
+    uringLoops_.clear();
+    LOG_INFO(INS()) << "server stopped" << std::endl;
+}
+
+void WebServer::stop() {
+    uint64_t one = 1;
+    ssize_t n = write(wakeFd_, &one, sizeof(one));
+    (void)n;
+}
+
+size_t WebServer::connectionCount() {
+    std::lock_guard<std::mutex> lck(connMtx_);
+    size_t count = conns_.size();
+    for(auto& loop : loops_) {
+        count += loop->connectionCount();
+    }
+    for(auto& loop : uringLoops_) {
+        count += loop->connectionCount();
+    }
+    return count;
+}
+
+// 边沿触发，必须一直 accept 到 EAGAIN
+void WebServer::handleAccept() {
+    while(true) {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int fd = accept4(listenFd_, (struct sockaddr*)&addr, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            if(errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_WARN(INS()) << "accept error, errno " << errno << std::endl;
+            }
+            return;
+        }
+        if(!overload_.acquireConnection()) {
+            close(fd);
+            continue;
+        }
+        setNoDelay(fd);
+        Connection* conn = new Connection(fd, addr, ++nextId_, &config_.handler);
+        {
+            std::lock_guard<std::mutex> lck(connMtx_);
+            conns_[fd] = conn;
+            armTimer(conn, overload_.firstCheckMs());
+        }
+        if(!epoller_.addFd(fd, EPOLLIN | kConnEvents, conn)) {
+            closeConn(conn);
+        }
+    }
+}
+
+void WebServer::armTimer(Connection* conn, int delayMs) {
+    if(delayMs < 0) {
+        return;
+    }
+    int fd = conn->getFd();
+    uint64_t id = conn->getId();
+    conn->setTimer(wheel_.schedule(std::chrono::milliseconds(delayMs), [this, fd, id] { onTimer(fd, id); }));
+}
+
+// 在主线程执行；连接可能已关闭、fd 可能已被新连接复用，按 fd 查到后还要核对连接 id
+void WebServer::onTimer(int fd, uint64_t id) {
+    std::lock_guard<std::mutex> lck(connMtx_);
+    auto it = conns_.find(fd);
+    if(it == conns_.end() || it->second->getId() != id) {
+        return;
+    }
+    Connection* conn = it->second;
+    conn->setTimer(0);
+    int left = overload_.checkTimeout(*conn, Connection::nowMs());
+    if(left == 0) {
+        // 持有 connMtx_ 时连接不会被释放，fd 仍然有效
+        shutdown(fd, SHUT_RDWR);
+        return;
+    }
+    armTimer(conn, left);
+}
+
+void WebServer::dispatch(Connection* conn, uint32_t events) {
+    // 线程池排队过久时不再入队，在主线程上直接读取并回 503；EPOLLONESHOT 保证此时没有工作线程持有该连接
+    if((events & EPOLLIN) && (conn->isRejecting() || overload_.shouldShed(pool_))) {
+        conn->setRejecting(true);
+        onEvent(conn, events);
+        return;
+    }
+    ++inflight_;
+    pool_.addTask([this, conn, events] {
+        onEvent(conn, events);
+        --inflight_;
+    });
+}
+
+// 单 Reactor 模式下 handler 已在工作线程上，推迟的响应就地生成
+static void processInline(Connection* conn) {
+    conn->process();
+    while(conn->isDeferred()) {
+        conn->takeDeferred()();
+        conn->finishDeferred();
+        conn->process();
+    }
+}
+
+// 在工作线程上执行：读、处理、写，最后根据剩余输出重新激活读或写事件
+void WebServer::onEvent(Connection* conn, uint32_t events) {
+    int saveErrno = 0;
+    if(events & EPOLLERR) {
+        closeConn(conn);
+        return;
+    }
+    if(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+        if(conn->read(&saveErrno) < 0) {
+            closeConn(conn);
+            return;
+        }
+        processInline(conn);
+    }
+    do {
+        if(conn->isBlocked()) {
+            processInline(conn);
+        }
+        if(conn->toWriteBytes() > 0) {
+            if(conn->write(&saveErrno) < 0) {
+                closeConn(conn);
+                return;
+            }
+            if(conn->toWriteBytes() > 0) {
+                conn->touch(Connection::nowMs());
+                epoller_.modFd(conn->getFd(), EPOLLOUT | kConnEvents, conn);
+                return;
+            }
+        }
+    } while(conn->isBlocked());
+    if(conn->isClosing()) {
+        closeConn(conn);
+        return;
+    }
+    conn->touch(Connection::nowMs());
+    epoller_.modFd(conn->getFd(), EPOLLIN | kConnEvents, conn);
+}
+
+void WebServer::closeConn(Connection* conn) {
+    epoller_.delFd(conn->getFd());
+    {
+        std::lock_guard<std::mutex> lck(connMtx_);
+        conns_.erase(conn->getFd());
+        if(conn->timer()) {
+            wheel_.cancel(conn->timer());
+        }
+    }
+    overload_.releaseConnection();
+    delete conn;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "epoller.h"
+#include "connection.h"
+#include "eventLoop.h"
+#include "uringLoop.h"
+#include "overload.h"
+#include "../Pool/timerWheel.hpp"
+#include "../Pool/threadPool.hpp"
+
+/**
+ * Reactor：主线程用边沿触发的 epoll 监听，accept 在主线程完成
+ * 连接以 EPOLLONESHOT 注册，就绪后整个读-处理-写过程交给 ThreadPool 的工作线程
+ * 工作线程处理完后重新激活 EPOLLIN 或 EPOLLOUT，保证同一连接不会被两个线程同时处理
+ *
+ * loops > 0 时改为多 Reactor 模式：启动 loops 个 EventLoop 线程，各自监听 SO_REUSEPORT socket，
+ * 连接在所属循环线程上内联处理，只有 HttpResponse::defer() 推迟的响应交给线程池生成；
+ * 循环按进程允许的 CPU 依次绑核，见 loopCpus
+ * 多 Reactor 模式下 uring 为 true 时改用 UringLoop，内核不支持 io_uring 时自动回退到 EventLoop
+ *
+ * 过载保护见 OverloadControl：单 Reactor 模式下连接的超时定时器挂在主线程的 TimerWheel 上，
+ * 超时只对连接做 shutdown，由随后的挂断事件走正常的关闭流程，避免与正在处理该连接的工作线程竞争；
+ * 线程池排队过久时，新读到请求的事件不再入队，在主线程上直接回 503；
+ * 多 Reactor 模式下改按事件循环的滞后判断，在循环线程上回 503
+*/
+class WebServer {
+public:
+    struct Config {
+        int port = 8080;
+        int maxEvents = 1024;
+        ThreadPool::Config pool;
+        int loops = 0;                  // 多 Reactor 模式的事件循环数，0 为单 Reactor + 线程池
+        std::vector<int> loopCpus;      // 第 i 个循环绑定到 loopCpus[i % loopCpus.size()]
+        bool uring = false;             // 多 Reactor 模式下使用 io_uring 后端
+        OverloadControl::Config overload;
+        int statsIntervalMs = 60000;    // 定期把线程池与过载保护的统计写入日志，0 只在停止时输出
+        HttpHandler handler;            // 请求处理函数，在工作线程或循环线程上调用，需可重入
+    };
+
+    explicit WebServer(const Config& config);
+    ~WebServer();
+
+    // 运行事件循环，直到 stop() 被调用
+    void start();
+    // 可在任意线程调用
+    void stop();
+
+    size_t connectionCount();
+
+private:
+    bool initListen();
+    void runLoops();
+    bool startUringLoops();
+    void handleAccept();
+    void dispatch(Connection* conn, uint32_t events);
+    void onEvent(Connection* conn, uint32_t events);
+    void closeConn(Connection* conn);
+    // 调用者须持有 connMtx_
+    void armTimer(Connection* conn, int delayMs);
+    void onTimer(int fd, uint64_t id);
+    void logStats();
+
+    static const uint32_t kConnEvents = EPOLLET | EPOLLONESHOT | EPOLLRDHUP;
+
+    Config config_;
+    int listenFd_ = -1;
+    int wakeFd_ = -1;
+    bool isClosed_ = false;
+    uint64_t nextId_ = 0;
+
+    Epoller epoller_;
+    ThreadPool pool_;
+    OverloadControl overload_;
+    TimerWheel wheel_;      // 只在主线程推进
+
+    std::mutex connMtx_;
+    std::unordered_map<int, Connection*> conns_;
+    std::atomic<int> inflight_{0};   // 已投递到线程池但尚未处理完的事件数
+
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    std::vector<std::unique_ptr<UringLoop>> uringLoops_;
+    std::vector<std::thread> loopThreads_;
+};
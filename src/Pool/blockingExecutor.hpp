@@ -0,0 +1,82 @@
+#pragma once
+
+#include <utility>
+#include <exception>
+#include <type_traits>
+#include "threadPool.hpp"
+
+/**
+ * 阻塞任务执行器：磁盘读写、同步刷日志等会阻塞在系统调用上的任务放到这里
+ * 与 CPU 线程池分开排队、分开限制线程数，阻塞任务不会占住 CPU 工作线程
+ * 默认配置下没有常驻线程，没有空闲线程时立即扩容，空闲 10 秒后回收，不绑核
+*/
+class BlockingExecutor {
+public:
+    static ThreadPool::Config defaultConfig() {
+        ThreadPool::Config config;
+        config.name = "BlockingExecutor";
+        config.minThreads = 0;
+        config.maxThreads = 64;
+        config.spawnWait = std::chrono::milliseconds(0);
+        config.idleTimeout = std::chrono::milliseconds(10000);
+        return config;
+    }
+
+    BlockingExecutor() : pool_(defaultConfig()) {}
+
+    explicit BlockingExecutor(const ThreadPool::Config& config) : pool_(config) {}
+
+    template<class F>
+    void addTask(F&& task) {
+        pool_.addTask(std::forward<F>(task));
+    }
+
+    /**
+     * 在本执行器上运行阻塞的 work，完成后在 cpuPool 上调用 done
+     * done 的第一个参数是 work 抛出的异常，正常结束时为空；work 返回 void 时只有这一个参数，
+     * 否则第二个参数是 work 的返回值，抛出异常时为值初始化的对象
+     */
+    template<class F, class Done>
+    void offload(F&& work, ThreadPool& cpuPool, Done&& done) {
+        pool_.addTask([work = std::forward<F>(work), done = std::forward<Done>(done), &cpuPool]() mutable {
+            typedef typename std::invoke_result<F&>::type R;
+            std::exception_ptr error;
+            if constexpr (std::is_void<R>::value) {
+                try {
+                    work();
+                }
+                catch(...) {
+                    error = std::current_exception();
+                }
+                cpuPool.addTask([done = std::move(done), error]() mutable {
+                    done(error);
+                });
+            }
+            else {
+                static_assert(std::is_default_constructible<R>::value,
+                              "offload work must return void or a default constructible type");
+                R result{};
+                try {
+                    result = work();
+                }
+                catch(...) {
+                    error = std::current_exception();
+                }
+                cpuPool.addTask([done = std::move(done), error, result = std::move(result)]() mutable {
+                    done(error, std::move(result));
+                });
+            }
+        });
+    }
+
+    PoolStats stats() {
+        return pool_.stats();
+    }
+
+    void logStats() {
+        pool_.logStats();
+    }
+
+private:
+    ThreadPool pool_;
+};
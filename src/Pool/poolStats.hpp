@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * 对数-线性分桶的延迟直方图（HDR 风格），单位纳秒
+ * 每个 2 的幂区间再均分 16 个子桶，相对误差约 6%，可记录到 2^40ns（约 18 分钟）
+ * 每个工作线程只写自己的直方图，因此 record 只用 relaxed 的读和写，不需要原子加
+*/
+class LatencyHistogram {
+public:
+    static const int SUB_BITS = 4;
+    static const uint64_t SUB_COUNT = 1 << SUB_BITS;
+    static const int MAX_EXP = 40;
+    static const size_t BUCKETS = (MAX_EXP - SUB_BITS + 2) * SUB_COUNT;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(BUCKETS, 0);
+
+        void merge(const Snapshot& other) {
+            count += other.count;
+            sum += other.sum;
+            max = other.max > max ? other.max : max;
+            for(size_t i = 0; i < BUCKETS; ++i) {
+                buckets[i] += other.buckets[i];
+            }
+        }
+
+        uint64_t mean() const {
+            return count ? sum / count : 0;
+        }
+
+        // q 取 [0, 1]，返回所在桶的中值
+        uint64_t percentile(double q) const {
+            if(count == 0) {
+                return 0;
+            }
+            uint64_t rank = static_cast<uint64_t>(q * count);
+            if(rank >= count) {
+                rank = count - 1;
+            }
+            uint64_t seen = 0;
+            for(size_t i = 0; i < BUCKETS; ++i) {
+                seen += buckets[i];
+                if(seen > rank) {
+                    uint64_t v = bucketMid(i);
+                    return v < max ? v : max;
+                }
+            }
+            return max;
+        }
+    };
+
+    void record(uint64_t ns) {
+        bump(buckets_[bucketOf(ns)], 1);
+        bump(count_, 1);
+        bump(sum_, ns);
+        if(ns > max_.load(std::memory_order_relaxed)) {
+            max_.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    void snapshot(Snapshot& out) const {
+        out.count = count_.load(std::memory_order_relaxed);
+        out.sum = sum_.load(std::memory_order_relaxed);
+        out.max = max_.load(std::memory_order_relaxed);
+        for(size_t i = 0; i < BUCKETS; ++i) {
+            out.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    static size_t bucketOf(uint64_t v) {
+        if(v < SUB_COUNT) {
+            return v;
+        }
+        int exp = 63 - __builtin_clzll(v);
+        if(exp > MAX_EXP) {
+            return BUCKETS - 1;
+        }
+        return (exp - SUB_BITS + 1) * SUB_COUNT + ((v >> (exp - SUB_BITS)) - SUB_COUNT);
+    }
+
+    static uint64_t bucketMid(size_t idx) {
+        if(idx < SUB_COUNT) {
+            return idx;
+        }
+        int exp = static_cast<int>(idx / SUB_COUNT) + SUB_BITS - 1;
+        uint64_t low = (SUB_COUNT + idx % SUB_COUNT) << (exp - SUB_BITS);
+        return low + ((1ULL << (exp - SUB_BITS)) >> 1);
+    }
+
+private:
+    // 单写者计数，避免 lock 前缀的原子加
+    static void bump(std::atomic<uint64_t>& c, uint64_t n) {
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets_[BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// 每个工作线程槽位一份，按缓存行对齐避免伪共享
+struct alignas(64) WorkerStats {
+    std::atomic<uint64_t> tasks{0};       // 执行的任务数
+    std::atomic<uint64_t> idleWaits{0};   // 进入空闲等待的次数
+    LatencyHistogram wait;                // 入队到开始执行的等待时间
+    LatencyHistogram exec;                // 任务执行时间
+};
+
+struct PoolStats {
+    size_t threads = 0;
+    size_t idle = 0;
+    size_t queueDepth = 0;
+    size_t queueHighWater = 0;      // 队列长度历史最大值
+    uint64_t spawned = 0;           // 累计创建的线程数
+    uint64_t retired = 0;           // 因空闲超时退出的线程数
+    uint64_t tasks = 0;
+    uint64_t idleWaits = 0;
+    std::vector<uint64_t> workerTasks;  // 按槽位统计的任务数
+    LatencyHistogram::Snapshot wait;
+    LatencyHistogram::Snapshot exec;
+};
@@ -1,57 +1,323 @@
 #pragma once
 
 #include <mutex>
+#include <deque>
 #include <queue>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
 #include <thread>
+#include <string>
+#include <vector>
+#include <sched.h>
 #include <assert.h>
+#include <pthread.h>
 #include <functional>
 #include <condition_variable>
 #include "../Log/log.h"
+#include "poolStats.hpp"
 
+/**
+ * 弹性线程池：线程数在 [minThreads, maxThreads] 之间伸缩
+ * 扩容：没有空闲线程且队首任务等待超过 spawnWait 时新建线程；所有线程都被长任务占住时，
+ *       由一个监督线程定时复查，每个 spawnWait 至多新建一个线程
+ * 缩容：线程空闲超过 idleTimeout 且线程数多于 minThreads 时退出
+ * 绑核：cpus 非空时，槽位为 i 的线程绑定到 cpus[i % cpus.size()]
+ * 统计：每个槽位记录任务数与等待/执行时间直方图，stats() 汇总，logStats() 输出到日志
+ *       WebServer 用主线程的 TimerWheel 每 statsIntervalMs 输出一次: wheel.schedulePeriodic(d, d, [&pool] { pool.logStats(); })
+ * 排队：queueDelay() 无锁返回队首任务已等待的时间，上层据此做接入控制
+*/
 class ThreadPool {
 public:
-    explicit ThreadPool(int threadCount = 8) : pool_(std::make_shared<Pool>()) {
-        assert(threadCount > 0);
-        LOG_INFO(INS()) << "ThreadPool inited." << std::endl;
-        for(int i = 0; i < threadCount; ++i) {
-            std::thread([pool = pool_] {
-                std::unique_lock<std::mutex> lck(pool->mtx_);
-                while(true) {
-                    if(!pool->tasks_.empty()) {
-                        //move()直接移动对象，避免再构造一次对象
-                        auto task = std::move(pool->tasks_.front());
-                        pool->tasks_.pop();
-                        lck.unlock();
-                        LOG_DEBUG(INS()) << "exec one task" << std::endl;
-                        task();
-                        lck.lock();
-                    }
-                    else if(pool->isClosed_) {
-                        LOG_INFO(INS()) << "threadpool close!" << std::endl;
-                        break;
-                    }
-                    else {
-                        pool->cond_.wait(lck);
-                    }
-                }
-            }).detach();
+    typedef std::chrono::steady_clock Clock;
+
+    struct Config {
+        std::string name = "ThreadPool";   // 日志中区分不同的线程池
+        size_t minThreads = 1;
+        size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::chrono::milliseconds spawnWait{5};
+        std::chrono::milliseconds idleTimeout{30000};
+        std::vector<int> cpus;
+    };
+
+    // 固定大小的线程池
+    explicit ThreadPool(int threadCount) : ThreadPool(fixedConfig(threadCount)) {}
+
+    explicit ThreadPool(const Config& config) : pool_(std::make_shared<Pool>()) {
+        assert(config.maxThreads > 0 && config.minThreads <= config.maxThreads);
+        pool_->config_ = config;
+        LOG_INFO(INS()) << config.name << " inited, threads [" << config.minThreads
+                        << ", " << config.maxThreads << "]" << std::endl;
+        std::lock_guard<std::mutex> lck(pool_->mtx_);
+        for(size_t i = 0; i < config.minThreads; ++i) {
+            spawn(pool_);
+        }
+        if(config.maxThreads > config.minThreads) {
+            std::thread(supervise, pool_).detach();
         }
     }
 
-    ThreadPool() = default;
+    ThreadPool() : ThreadPool(Config()) {}
 
     ThreadPool(ThreadPool&&) = default;
 
+    // 工作线程是分离的，排队的任务执行完后自行退出；日志在这里写，
+    // 进程退出时最后一个工作线程可能晚于全局日志器析构
     ~ThreadPool() {
-        pool_->isClosed_ = true;
+        if(pool_) {
+            std::lock_guard<std::mutex> lck(pool_->mtx_);
+            pool_->isClosed_ = true;
+            pool_->cond_.notify_all();
+            pool_->superCond_.notify_all();
+            LOG_INFO(INS()) << pool_->config_.name << " close!" << std::endl;
+        }
     }
+
+    template<class F>
+    void addTask(F&& task) {
+        std::lock_guard<std::mutex> lck(pool_->mtx_);
+        pool_->tasks_.push(Task{std::function<void()>(std::forward<F>(task)), Clock::now()});
+        if(pool_->tasks_.size() == 1) {
+            pool_->headEnqueue_.store(pool_->tasks_.front().enqueue.time_since_epoch().count(),
+                                      std::memory_order_relaxed);
+        }
+        if(pool_->tasks_.size() > pool_->queueHighWater_) {
+            pool_->queueHighWater_ = pool_->tasks_.size();
+        }
+        if(pool_->idle_ > 0) {
+            pool_->cond_.notify_one();
+        }
+        else {
+            growIfStarved(pool_, Clock::now());
+        }
+        // 排队任务多于被唤醒的空闲线程时才需要监督线程计时
+        if(pool_->superParked_ && pool_->tasks_.size() > pool_->idle_) {
+            pool_->superCond_.notify_one();
+        }
+    }
+
+    size_t threadCount() {
+        std::lock_guard<std::mutex> lck(pool_->mtx_);
+        return pool_->threads_;
+    }
+
+    size_t idleCount() {
+        std::lock_guard<std::mutex> lck(pool_->mtx_);
+        return pool_->idle_;
+    }
+
+    size_t queueSize() {
+        std::lock_guard<std::mutex> lck(pool_->mtx_);
+        return pool_->tasks_.size();
+    }
+
+    // 队首任务已排队的时间，队列为空时为 0；不加锁，供接入控制在每个请求上调用
+    Clock::duration queueDelay() const {
+        Clock::rep head = pool_->headEnqueue_.load(std::memory_order_relaxed);
+        if(head == 0) {
+            return Clock::duration::zero();
+        }
+        Clock::duration delay = Clock::now().time_since_epoch() - Clock::duration(head);
+        return delay > Clock::duration::zero() ? delay : Clock::duration::zero();
+    }
+
+    PoolStats stats() {
+        PoolStats st;
+        std::lock_guard<std::mutex> lck(pool_->mtx_);
+        st.threads = pool_->threads_;
+        st.idle = pool_->idle_;
+        st.queueDepth = pool_->tasks_.size();
+        st.queueHighWater = pool_->queueHighWater_;
+        st.spawned = pool_->spawned_;
+        st.retired = pool_->retired_;
+        LatencyHistogram::Snapshot tmp;
+        for(auto& ws : pool_->workers_) {
+            uint64_t tasks = ws.tasks.load(std::memory_order_relaxed);
+            st.tasks += tasks;
+            st.idleWaits += ws.idleWaits.load(std::memory_order_relaxed);
+            st.workerTasks.push_back(tasks);
+            ws.wait.snapshot(tmp);
+            st.wait.merge(tmp);
+            ws.exec.snapshot(tmp);
+            st.exec.merge(tmp);
+        }
+        return st;
+    }
+
+    void logStats() {
+        PoolStats st = stats();
+        std::ostringstream workers;
+        for(size_t i = 0; i < st.workerTasks.size(); ++i) {
+            workers << (i ? "," : "") << st.workerTasks[i];
+        }
+        LOG_INFO(INS()) << pool_->config_.name << " threads " << st.threads << " idle " << st.idle
+                        << " spawned " << st.spawned << " retired " << st.retired
+                        << " queue " << st.queueDepth << " queueMax " << st.queueHighWater
+                        << " tasks " << st.tasks << " idleWaits " << st.idleWaits
+                        << " perWorker [" << workers.str() << "]"
+                        << " wait(us) p50 " << st.wait.percentile(0.5) / 1000
+                        << " p99 " << st.wait.percentile(0.99) / 1000
+                        << " p999 " << st.wait.percentile(0.999) / 1000
+                        << " max " << st.wait.max / 1000
+                        << " exec(us) p50 " << st.exec.percentile(0.5) / 1000
+                        << " p99 " << st.exec.percentile(0.99) / 1000
+                        << " p999 " << st.exec.percentile(0.999) / 1000
+                        << " max " << st.exec.max / 1000 << std::endl;
+    }
+
+    // 进程允许运行的 CPU 编号，受 taskset / cgroup 限制，获取失败时返回空
+    static std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if(sched_getaffinity(0, sizeof(set), &set) != 0) {
+            return cpus;
+        }
+        for(int i = 0; i < CPU_SETSIZE; ++i) {
+            if(CPU_ISSET(i, &set)) {
+                cpus.push_back(i);
+            }
+        }
+        return cpus;
+    }
+
+    // 把调用线程绑定到 cpus[slot % cpus.size()]，cpus 为空时不做任何事
+    static void pinToCpu(const std::vector<int>& cpus, size_t slot) {
+        if(cpus.empty()) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[slot % cpus.size()], &set);
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if(ret != 0) {
+            LOG_WARN(INS()) << "pin thread " << slot << " to cpu " << cpus[slot % cpus.size()]
+                            << " failed, errno " << ret << std::endl;
+        }
+    }
+
 private:
+    struct Task {
+        std::function<void()> fn;
+        Clock::time_point enqueue;
+    };
+
     struct Pool {
         std::mutex mtx_;
-        bool isClosed_;
+        bool isClosed_ = false;
         std::condition_variable cond_;
-        std::queue<std::function<void()>> tasks_;
+        std::condition_variable superCond_;  // 唤醒监督线程
+        bool superParked_ = false;           // 监督线程在无限期等待
+        std::queue<Task> tasks_;
+        Config config_;
+        size_t threads_ = 0;             // 存活线程数
+        size_t idle_ = 0;                // 阻塞在条件变量上的线程数
+        std::vector<size_t> freeSlots_;  // 已退出线程让出的槽位，优先复用以保持绑核稳定
+        size_t nextSlot_ = 0;
+        std::deque<WorkerStats> workers_;  // 按槽位存放，deque 扩容不会使已有元素地址失效
+        size_t queueHighWater_ = 0;
+        std::atomic<Clock::rep> headEnqueue_{0};  // 队首任务的入队时间，队列为空时为 0；在 mtx_ 内写
+        uint64_t spawned_ = 0;
+        uint64_t retired_ = 0;
     };
+
+    static Config fixedConfig(int threadCount) {
+        assert(threadCount > 0);
+        Config config;
+        config.minThreads = config.maxThreads = threadCount;
+        return config;
+    }
+
+    // 调用者须持有 mtx_
+    static void spawn(const std::shared_ptr<Pool>& pool) {
+        size_t slot;
+        if(!pool->freeSlots_.empty()) {
+            slot = pool->freeSlots_.back();
+            pool->freeSlots_.pop_back();
+        }
+        else {
+            slot = pool->nextSlot_++;
+            pool->workers_.emplace_back();
+        }
+        ++pool->threads_;
+        ++pool->spawned_;
+        std::thread(run, pool, slot).detach();
+    }
+
+    // 调用者须持有 mtx_，没有空闲线程时按队首等待时间决定是否扩容
+    static void growIfStarved(const std::shared_ptr<Pool>& pool, Clock::time_point now) {
+        const Config& cfg = pool->config_;
+        if(pool->isClosed_ || pool->idle_ > 0 || pool->tasks_.empty() || pool->threads_ >= cfg.maxThreads) {
+            return;
+        }
+        if(pool->threads_ < cfg.minThreads || pool->threads_ == 0
+           || now - pool->tasks_.front().enqueue >= cfg.spawnWait) {
+            spawn(pool);
+        }
+    }
+
+    // 监督线程：addTask 和出队时的检查都依赖有线程来调用，线程全被占住时由这里按队首的等待时间复查
+    static void supervise(std::shared_ptr<Pool> pool) {
+        std::unique_lock<std::mutex> lck(pool->mtx_);
+        const Config& cfg = pool->config_;
+        while(!pool->isClosed_) {
+            // 每个空闲线程都会取走一个任务，排队数不超过空闲数时不会饿死
+            if(pool->tasks_.size() <= pool->idle_ || pool->threads_ >= cfg.maxThreads) {
+                pool->superParked_ = true;
+                pool->superCond_.wait(lck);
+                pool->superParked_ = false;
+                continue;
+            }
+            Clock::time_point deadline = pool->tasks_.front().enqueue + cfg.spawnWait;
+            if(Clock::now() < deadline) {
+                pool->superCond_.wait_until(lck, deadline);
+                continue;
+            }
+            growIfStarved(pool, Clock::now());
+            // 新线程取走任务需要时间，隔一个 spawnWait 再复查，避免一次建满
+            pool->superCond_.wait_for(lck, cfg.spawnWait);
+        }
+    }
+
+    static void run(std::shared_ptr<Pool> pool, size_t slot) {
+        pinToCpu(pool->config_.cpus, slot);
+        std::unique_lock<std::mutex> lck(pool->mtx_);
+        WorkerStats& ws = pool->workers_[slot];
+        while(true) {
+            if(!pool->tasks_.empty()) {
+                //move()直接移动对象，避免再构造一次对象
+                auto task = std::move(pool->tasks_.front());
+                pool->tasks_.pop();
+                pool->headEnqueue_.store(pool->tasks_.empty() ? 0 : pool->tasks_.front().enqueue.time_since_epoch().count(),
+                                         std::memory_order_relaxed);
+                Clock::time_point begin = Clock::now();
+                growIfStarved(pool, begin);
+                lck.unlock();
+                task.fn();
+                Clock::time_point end = Clock::now();
+                ws.wait.record(std::chrono::duration_cast<std::chrono::nanoseconds>(begin - task.enqueue).count());
+                ws.exec.record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+                ws.tasks.store(ws.tasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                lck.lock();
+            }
+            else if(pool->isClosed_) {
+                break;
+            }
+            else {
+                ++pool->idle_;
+                ws.idleWaits.store(ws.idleWaits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                auto status = pool->cond_.wait_for(lck, pool->config_.idleTimeout);
+                --pool->idle_;
+                if(status == std::cv_status::timeout && pool->tasks_.empty() && !pool->isClosed_
+                   && pool->threads_ > pool->config_.minThreads) {
+                    ++pool->retired_;
+                    break;
+                }
+            }
+        }
+        --pool->threads_;
+        pool->freeSlots_.push_back(slot);
+    }
+
     std::shared_ptr<Pool> pool_;
 };
-
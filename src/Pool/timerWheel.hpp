@@ -0,0 +1,334 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <assert.h>
+#include <functional>
+#include <condition_variable>
+#include "threadPool.hpp"
+
+/**
+ * 分层时间轮，结构同 Linux 内核的 timer wheel
+ * 第一层 256 个槽，每槽 1 个 tick；其余四层各 64 个槽，每槽跨度为上一层的整圈
+ * 定时器挂在槽位的双向链表上，添加、取消均为 O(1)；到期时高层槽位整体下沉到低层
+ * 到期回调投递到 ThreadPool 执行，未指定线程池时在推进时间轮的线程上直接执行
+*/
+class TimerWheel {
+public:
+    typedef uint64_t TimerId;   // 高 32 位为代数，低 32 位为节点下标，0 表示无效
+    typedef std::function<void()> Callback;
+    typedef std::chrono::steady_clock Clock;
+
+    explicit TimerWheel(ThreadPool* pool = nullptr, std::chrono::milliseconds tick = std::chrono::milliseconds(1))
+        : pool_(pool), tick_(tick), start_(Clock::now()) {
+        assert(tick.count() > 0);
+        for(auto& slot : slots_) {
+            slot.prev_ = slot.next_ = &slot;
+        }
+    }
+
+    ~TimerWheel() {
+        stop();
+    }
+
+    // 启动独立的驱动线程；由外部事件循环驱动时不调用，改为定期调用 advance()
+    void start() {
+        std::lock_guard<std::mutex> lck(mtx_);
+        if(ticker_.joinable()) {
+            return;
+        }
+        isClosed_ = false;
+        ticker_ = std::thread([this] {
+            std::unique_lock<std::mutex> lck(mtx_);
+            while(!isClosed_) {
+                if(count_ == 0) {
+                    cond_.wait(lck);
+                }
+                else {
+                    cond_.wait_until(lck, nextTick());
+                }
+                if(isClosed_) {
+                    break;
+                }
+                lck.unlock();
+                advance();
+                lck.lock();
+            }
+        });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lck(mtx_);
+            isClosed_ = true;
+            cond_.notify_all();
+        }
+        if(ticker_.joinable()) {
+            ticker_.join();
+        }
+    }
+
+    TimerId schedule(std::chrono::milliseconds delay, Callback cb) {
+        return add(delay, std::chrono::milliseconds(0), std::move(cb));
+    }
+
+    // 首次在 delay 后触发，之后每隔 interval 触发一次，直到 cancel
+    TimerId schedulePeriodic(std::chrono::milliseconds delay, std::chrono::milliseconds interval, Callback cb) {
+        assert(interval.count() > 0);
+        return add(delay, interval, std::move(cb));
+    }
+
+    // 已触发的一次性定时器或重复取消返回 false
+    bool cancel(TimerId id) {
+        std::lock_guard<std::mutex> lck(mtx_);
+        Node* node = lookup(id);
+        if(node == nullptr) {
+            return false;
+        }
+        unlink(node);
+        release(node);
+        return true;
+    }
+
+    // 把时间轮推进到当前时间，执行期间到期的回调
+    void advance() {
+        std::vector<Callback> expired;
+        {
+            std::lock_guard<std::mutex> lck(mtx_);
+            uint64_t target = currentTick();
+            if(count_ == 0) {
+                skipIdle(target);
+            }
+            while(now_ <= target) {
+                size_t index = now_ & TVR_MASK;
+                if(index == 0 && cascade(1, levelIndex(0)) == 0 && cascade(2, levelIndex(1)) == 0
+                   && cascade(3, levelIndex(2)) == 0) {
+                    cascade(4, levelIndex(3));
+                }
+                uint64_t fired = now_++;
+                ListHead work;
+                takeList(&slots_[index], &work);
+                while(work.next_ != &work) {
+                    Node* node = static_cast<Node*>(work.next_);
+                    unlink(node);
+                    if(node->interval_ > 0) {
+                        expired.push_back(node->cb_);
+                        node->expire_ = fired + node->interval_;
+                        link(node);
+                    }
+                    else {
+                        expired.push_back(std::move(node->cb_));
+                        release(node);
+                    }
+                }
+            }
+        }
+        for(auto& cb : expired) {
+            if(pool_) {
+                pool_->addTask(std::move(cb));
+            }
+            else {
+                cb();
+            }
+        }
+    }
+
+    // 距离下一个 tick 的毫秒数，供 epoll_wait 作为超时；没有定时器时返回 -1
+    int nextTimeoutMs() {
+        std::lock_guard<std::mutex> lck(mtx_);
+        if(count_ == 0) {
+            return -1;
+        }
+        // 向上取整，否则不足 1ms 时返回 0，调用者会空转到下一个 tick
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(nextTick() - Clock::now());
+        return wait.count() > 0 ? static_cast<int>(wait.count()) : 0;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lck(mtx_);
+        return count_;
+    }
+
+private:
+    static const int TVR_BITS = 8;
+    static const int TVN_BITS = 6;
+    static const size_t TVR_SIZE = 1 << TVR_BITS;
+    static const size_t TVN_SIZE = 1 << TVN_BITS;
+    static const uint64_t TVR_MASK = TVR_SIZE - 1;
+    static const uint64_t TVN_MASK = TVN_SIZE - 1;
+    static const int LEVELS = 5;
+
+    struct ListHead {
+        ListHead* prev_ = nullptr;
+        ListHead* next_ = nullptr;
+    };
+
+    struct Node : ListHead {
+        uint64_t expire_ = 0;       // 到期的 tick
+        uint64_t interval_ = 0;     // 周期 tick 数，0 表示一次性
+        uint32_t index_ = 0;        // 在 nodes_ 中的下标
+        uint32_t gen_ = 1;          // 节点每次回收后加一，使旧的 TimerId 失效
+        bool active_ = false;
+        Callback cb_;
+    };
+
+    // now_ 是无符号数，先转成有符号再乘，否则与当前时间相减会回绕成很大的正数
+    Clock::time_point nextTick() const {
+        return start_ + tick_ * static_cast<int64_t>(now_);
+    }
+
+    uint64_t currentTick() const {
+        return (Clock::now() - start_) / tick_;
+    }
+
+    uint64_t toTicks(std::chrono::milliseconds d) const {
+        if(d.count() <= 0) {
+            return 0;
+        }
+        return (d + tick_ - std::chrono::milliseconds(1)) / tick_;
+    }
+
+    // 向上取整，保证回调不早于 delay 触发
+    uint64_t expireTick(std::chrono::milliseconds delay) const {
+        auto due = Clock::now() - start_ + std::max(delay, std::chrono::milliseconds(0));
+        return (due + tick_ - Clock::duration(1)) / tick_;
+    }
+
+    size_t levelIndex(int n) const {
+        return (now_ >> (TVR_BITS + n * TVN_BITS)) & TVN_MASK;
+    }
+
+    // 没有定时器时所有槽位都是空的，直接跳到 target，不必逐个 tick 推进；
+    // 否则空闲一小时后第一次推进要在锁内走完约 360 万个 1ms 的 tick
+    void skipIdle(uint64_t target) {
+        if(now_ < target) {
+            now_ = target;
+        }
+    }
+
+    TimerId add(std::chrono::milliseconds delay, std::chrono::milliseconds interval, Callback cb) {
+        std::lock_guard<std::mutex> lck(mtx_);
+        if(count_ == 0) {
+            skipIdle(currentTick());
+        }
+        Node* node;
+        if(!freeNodes_.empty()) {
+            node = &nodes_[freeNodes_.back()];
+            freeNodes_.pop_back();
+        }
+        else {
+            nodes_.emplace_back();
+            node = &nodes_.back();
+            node->index_ = static_cast<uint32_t>(nodes_.size() - 1);
+        }
+        node->active_ = true;
+        node->cb_ = std::move(cb);
+        node->interval_ = interval.count() > 0 ? std::max<uint64_t>(1, toTicks(interval)) : 0;
+        node->expire_ = expireTick(delay);
+        link(node);
+        if(count_++ == 0) {
+            cond_.notify_all();
+        }
+        return (static_cast<uint64_t>(node->gen_) << 32) | node->index_;
+    }
+
+    Node* lookup(TimerId id) {
+        uint32_t index = static_cast<uint32_t>(id);
+        uint32_t gen = static_cast<uint32_t>(id >> 32);
+        if(index >= nodes_.size() || nodes_[index].gen_ != gen || !nodes_[index].active_) {
+            return nullptr;
+        }
+        return &nodes_[index];
+    }
+
+    // 调用者须已将节点从链表摘下
+    void release(Node* node) {
+        node->active_ = false;
+        node->cb_ = nullptr;
+        ++node->gen_;
+        freeNodes_.push_back(node->index_);
+        --count_;
+    }
+
+    // 按到期时间放入对应层的槽位，同内核 internal_add_timer
+    void link(Node* node) {
+        uint64_t expire = node->expire_;
+        ListHead* slot;
+        if(expire < now_) {
+            slot = &slots_[now_ & TVR_MASK];
+        }
+        else {
+            uint64_t idx = expire - now_;
+            if(idx < TVR_SIZE) {
+                slot = &slots_[expire & TVR_MASK];
+            }
+            else {
+                int level = 1;
+                while(level < LEVELS - 1 && idx >= (1ULL << (TVR_BITS + level * TVN_BITS))) {
+                    ++level;
+                }
+                if(level == LEVELS - 1 && idx > 0xffffffffULL) {
+                    expire = now_ + 0xffffffffULL;
+                    node->expire_ = expire;
+                }
+                int shift = TVR_BITS + (level - 1) * TVN_BITS;
+                slot = &slots_[TVR_SIZE + (level - 1) * TVN_SIZE + ((expire >> shift) & TVN_MASK)];
+            }
+        }
+        ListHead* tail = slot->prev_;
+        node->prev_ = tail;
+        node->next_ = slot;
+        tail->next_ = node;
+        slot->prev_ = node;
+    }
+
+    static void unlink(ListHead* node) {
+        node->prev_->next_ = node->next_;
+        node->next_->prev_ = node->prev_;
+        node->prev_ = node->next_ = nullptr;
+    }
+
+    // 把 from 上的整条链表转移到 to，from 置空
+    static void takeList(ListHead* from, ListHead* to) {
+        if(from->next_ == from) {
+            to->prev_ = to->next_ = to;
+            return;
+        }
+        to->next_ = from->next_;
+        to->prev_ = from->prev_;
+        to->next_->prev_ = to;
+        to->prev_->next_ = to;
+        from->prev_ = from->next_ = from;
+    }
+
+    // 第 level 层 index 号槽位整体重新分配到低层
+    size_t cascade(int level, size_t index) {
+        ListHead work;
+        takeList(&slots_[TVR_SIZE + (level - 1) * TVN_SIZE + index], &work);
+        while(work.next_ != &work) {
+            Node* node = static_cast<Node*>(work.next_);
+            unlink(node);
+            link(node);
+        }
+        return index;
+    }
+
+    ThreadPool* pool_;
+    std::chrono::milliseconds tick_;
+    Clock::time_point start_;
+    uint64_t now_ = 0;      // 下一个待处理的 tick
+
+    ListHead slots_[TVR_SIZE + (LEVELS - 1) * TVN_SIZE];
+    std::deque<Node> nodes_;
+    std::vector<uint32_t> freeNodes_;
+    size_t count_ = 0;
+
+    std::mutex mtx_;
+    bool isClosed_ = false;
+    std::condition_variable cond_;
+    std::thread ticker_;
+};
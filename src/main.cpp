@@ -0,0 +1,145 @@
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <string>
+#include <thread>
+#include "Net/webServer.h"
+#include "Http/staticFile.h"
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "usage: %s [-p port] [-t threads] [-l loops] [-b epoll|uring] [-c config.yaml] [-L level] [-a] [-s ms]\n"
+            "  -p  listen port, default 8080\n"
+            "  -t  fixed ThreadPool size, default elastic 1..hardware threads\n"
+            "  -l  event loops; > 0 for multi-reactor mode, loop i pinned to the i-th allowed CPU, wrapping around\n"
+            "  -b  multi-reactor backend, uring falls back to epoll when unsupported\n"
+            "  -c  YAML file, its static and overload nodes configure StaticFileHandler and OverloadControl\n"
+            "  -L  log level: debug, info, warn, error, fatal\n"
+            "  -a  write an access log line per request at INFO level\n"
+            "  -s  interval for logging thread pool and overload stats, default 60000, 0 only at exit\n",
+            prog);
+}
+
+// 整个参数都是 [min, max] 内的十进制整数时写入 out 并返回 true
+static bool parseInt(const char* arg, long min, long max, int* out) {
+    char* end = nullptr;
+    errno = 0;
+    long v = strtol(arg, &end, 10);
+    if(errno != 0 || end == arg || *end != '\0' || v < min || v > max) {
+        return false;
+    }
+    *out = static_cast<int>(v);
+    return true;
+}
+
+// 等待 SIGINT/SIGTERM 后调用 server.stop()；doneFd 可读时表示服务器已自行退出，直接返回
+static void waitSignals(int sigFd, int doneFd, WebServer* server) {
+    struct pollfd fds[2] = {{sigFd, POLLIN, 0}, {doneFd, POLLIN, 0}};
+    while(poll(fds, 2, -1) < 0) {}
+    if(fds[0].revents & POLLIN) {
+        struct signalfd_siginfo info;
+        if(read(sigFd, &info, sizeof(info)) == sizeof(info)) {
+            LOG_INFO(INS()) << "received signal " << info.ssi_signo << ", stopping server" << std::endl;
+        }
+        server->stop();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    WebServer::Config config;
+    StaticFileHandler::Config staticConfig;
+    bool accessLog = false;
+    int opt;
+    while((opt = getopt(argc, argv, "p:t:l:b:c:L:as:h")) != -1) {
+        bool ok = true;
+        int threads = 0;
+        switch(opt) {
+            case 'p':
+                ok = parseInt(optarg, 1, 65535, &config.port);
+                break;
+            case 't':
+                ok = parseInt(optarg, 1, 4096, &threads);
+                config.pool.minThreads = config.pool.maxThreads = threads;
+                break;
+            case 'l':
+                ok = parseInt(optarg, 0, 1024, &config.loops);
+                // 循环数多于可用 CPU 时按编号轮流分配
+                config.loopCpus = ThreadPool::allowedCpus();
+                break;
+            case 'b':
+                config.uring = std::string(optarg) == "uring";
+                break;
+            case 'c':
+                staticConfig = StaticFileHandler::Config::loadFile(optarg);
+                config.overload = OverloadControl::Config::loadFile(optarg);
+                break;
+            case 'L':
+                if(Lwy::LogLevel::FromString(optarg) == Lwy::LogLevel::UNKNOW) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                INS()->setLevel(optarg);
+                break;
+            case 'a':
+                accessLog = true;
+                break;
+            case 's':
+                ok = parseInt(optarg, 0, INT_MAX, &config.statsIntervalMs);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 1;
+        }
+        if(!ok) {
+            fprintf(stderr, "invalid value for -%c: %s\n", opt, optarg);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // 在创建任何线程之前屏蔽，所有线程继承屏蔽字，两个信号只经 signalfd 送达
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+    int sigFd = signalfd(-1, &mask, SFD_CLOEXEC);
+    int doneFd = eventfd(0, EFD_CLOEXEC);
+    if(sigFd < 0 || doneFd < 0) {
+        perror("signalfd");
+        return 1;
+    }
+
+    StaticFileHandler files(staticConfig);
+    config.handler = [&files, accessLog](const HttpRequest& req, HttpResponse& resp) {
+        if(!files.serve(req, resp)) {
+            if(req.path == "/") {
+                resp.setContentType("text/plain");
+                resp.setBody("Hello, World!");
+            }
+            else {
+                resp.setStatus(404);
+            }
+        }
+        if(accessLog) {
+            LOG_INFO(INS()) << req.method << " " << req.target << " " << resp.getStatus() << std::endl;
+        }
+    };
+    WebServer server(config);
+    std::thread waiter(waitSignals, sigFd, doneFd, &server);
+    server.start();
+    uint64_t one = 1;
+    ssize_t n = write(doneFd, &one, sizeof(one));
+    (void)n;
+    waiter.join();
+    close(sigFd);
+    close(doneFd);
+    files.logStats();
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <string>
+#include <algorithm>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "check.h"
+#include "Net/buffer.h"
+
+static std::string pattern(size_t len) {
+    std::string s(len, '\0');
+    for(size_t i = 0; i < len; ++i) {
+        s[i] = static_cast<char>('a' + i % 26);
+    }
+    return s;
+}
+
+// 读空时两个指针都归零，容量即可写字节数
+static size_t capacity(const Buffer& buf) {
+    return buf.readableBytes() + buf.writableBytes();
+}
+
+// 超出可写区的部分先落在栈上的溢出区，再追加进缓冲
+static void testReadFdSpill() {
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    Buffer buf(64);
+    std::string data = pattern(64 + 1000);
+    CHECK(write(fds[0], data.data(), data.size()) == static_cast<ssize_t>(data.size()));
+    int saveErrno = 0;
+    CHECK(buf.readFd(fds[1], &saveErrno) == static_cast<ssize_t>(data.size()));
+    CHECK(buf.view() == data);
+
+    // 一次最多读满可写区加溢出区，剩下的下次再读
+    buf.retrieveAll();
+    buf.shrinkIfEmpty();
+    data = pattern(64 + Buffer::kExtraSize + 5000);
+    size_t sent = 0;
+    std::string got;
+    while(got.size() < data.size()) {
+        if(sent < data.size()) {
+            ssize_t n = write(fds[0], data.data() + sent, std::min<size_t>(data.size() - sent, 32768));
+            CHECK(n > 0);
+            sent += n;
+        }
+        size_t writable = buf.writableBytes();
+        ssize_t n = buf.readFd(fds[1], &saveErrno);
+        CHECK(n > 0 && static_cast<size_t>(n) <= writable + Buffer::kExtraSize);
+        got.append(buf.peek(), buf.readableBytes());
+        buf.retrieveAll();
+    }
+    CHECK(got == data);
+
+    // 对端关闭后读到 0，出错时返回 -1 并带回 errno
+    close(fds[0]);
+    CHECK(buf.readFd(fds[1], &saveErrno) == 0);
+    close(fds[1]);
+    CHECK(buf.readFd(fds[1], &saveErrno) == -1);
+    CHECK(saveErrno == EBADF);
+}
+
+// 前面已读的空间够用且可读数据不多时原地搬移，不重新分配
+static void testCompaction() {
+    Buffer buf(64);
+    std::string data = pattern(48);
+    buf.append(data);
+    buf.retrieve(40);
+    const char* base = buf.peek() - 40;
+    buf.append(pattern(40));
+    CHECK(buf.peek() == base);
+    CHECK(capacity(buf) == 64);
+    CHECK(buf.view() == data.substr(40) + pattern(40));
+}
+
+// 空间不够，或可读数据超过一半时按两倍扩容
+static void testDoubling() {
+    Buffer buf(64);
+    buf.append(pattern(60));
+    buf.append(pattern(10));
+    CHECK(capacity(buf) == 128);
+    buf.append(pattern(200));
+    CHECK(capacity(buf) == 512);
+    CHECK(buf.view() == pattern(60) + pattern(10) + pattern(200));
+
+    Buffer half(64);
+    std::string data = pattern(48);
+    half.append(data);
+    half.retrieve(8);
+    half.append(pattern(20));
+    CHECK(capacity(half) == 128);
+    CHECK(half.view() == data.substr(8) + pattern(20));
+}
+
+static void testRetrieveResets() {
+    Buffer buf(64);
+    buf.append(pattern(10));
+    buf.retrieve(4);
+    CHECK(buf.readableBytes() == 6);
+    CHECK(buf.writableBytes() == 54);
+    buf.retrieve(6);
+    CHECK(buf.readableBytes() == 0);
+    CHECK(buf.writableBytes() == 64);
+    buf.append(pattern(10));
+    buf.retrieveAll();
+    CHECK(buf.writableBytes() == 64);
+}
+
+static void testShrinkIfEmpty() {
+    Buffer buf(64);
+    const char* initial = buf.peek();
+    buf.shrinkIfEmpty();
+    CHECK(buf.peek() == initial);
+
+    buf.append(pattern(300));
+    CHECK(capacity(buf) == 512);
+    buf.retrieve(100);
+    buf.shrinkIfEmpty();
+    CHECK(buf.readableBytes() == 200);
+    CHECK(buf.view() == pattern(300).substr(100));
+    buf.retrieve(200);
+    buf.shrinkIfEmpty();
+    CHECK(buf.readableBytes() == 0);
+    CHECK(buf.writableBytes() == 64);
+    buf.append(pattern(10));
+    CHECK(buf.view() == pattern(10));
+}
+
+int main() {
+    testReadFdSpill();
+    testCompaction();
+    testDoubling();
+    testRetrieveResets();
+    testShrinkIfEmpty();
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include "check.h"
+#include "Coroutine/scheduler.hpp"
+
+using namespace std::chrono;
+
+template<class Pred>
+static bool waitFor(Pred pred, milliseconds timeout) {
+    auto deadline = steady_clock::now() + timeout;
+    while(!pred()) {
+        if(steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+static Task<int> add(CoScheduler& sched, int a, int b) {
+    co_await sched.yield();
+    co_return a + b;
+}
+
+// 依次走一遍 yield、sleep、waitFd、blocking，每一步都检查结果，最后一步置 done
+static Task<void> walk(CoScheduler& sched, int readFd, std::atomic<int>& step, std::atomic<bool>& done) {
+    int sum = co_await add(sched, 1, 2);
+    CHECK(sum == 3);
+    step = 1;
+
+    auto start = steady_clock::now();
+    co_await sched.sleep(milliseconds(50));
+    CHECK(steady_clock::now() - start >= milliseconds(50));
+    step = 2;
+
+    uint32_t revents = co_await sched.waitFd(readFd, EPOLLIN);
+    CHECK(revents & EPOLLIN);
+    char c = 0;
+    CHECK(read(readFd, &c, 1) == 1 && c == 'x');
+    step = 3;
+
+    std::thread::id caller = std::this_thread::get_id();
+    std::thread::id worker = co_await sched.blocking([] { return std::this_thread::get_id(); });
+    CHECK(worker != caller);
+    bool caught = false;
+    try {
+        co_await sched.blocking([] { throw std::runtime_error("disk error"); });
+    }
+    catch(const std::runtime_error&) {
+        caught = true;
+    }
+    CHECK(caught);
+    step = 4;
+    done = true;
+}
+
+static void testScheduler() {
+    ThreadPool pool(2);
+    BlockingExecutor blocking;
+    CoScheduler sched(pool, &blocking);
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    std::atomic<int> step{0};
+    std::atomic<bool> done{false};
+    sched.spawn(walk(sched, fds[0], step, done));
+    // 协程挂在 waitFd 上之后再写，确认是由 epoll 唤醒的
+    CHECK(waitFor([&] { return step.load() == 2; }, milliseconds(1000)));
+    std::this_thread::sleep_for(milliseconds(20));
+    CHECK(write(fds[1], "x", 1) == 1);
+    CHECK(waitFor([&] { return done.load(); }, milliseconds(1000)));
+    CHECK(step == 4);
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// offload 的 work 抛出异常时不应终止进程，异常交给 done
+static void testOffload() {
+    ThreadPool pool(1);
+    BlockingExecutor blocking;
+    std::atomic<int> value{0};
+    std::atomic<bool> failed{false};
+    blocking.offload([] { return 42; }, pool, [&](std::exception_ptr error, int result) {
+        CHECK(!error);
+        value = result;
+    });
+    blocking.offload([] { throw std::runtime_error("read failed"); }, pool, [&](std::exception_ptr error) {
+        CHECK(error);
+        try {
+            std::rethrow_exception(error);
+        }
+        catch(const std::runtime_error&) {
+            failed = true;
+        }
+    });
+    CHECK(waitFor([&] { return value.load() == 42 && failed.load(); }, milliseconds(1000)));
+}
+
+int main() {
+    INS()->setLevel("error");
+    testScheduler();
+    testOffload();
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include "check.h"
+#include "Net/eventLoop.h"
+#include "Net/uringLoop.h"
+
+// 推迟的响应在线程池上生成，done 回调与响应发出都回到循环线程
+struct Probe {
+    std::atomic<std::thread::id> loopThread;
+    std::atomic<std::thread::id> workThread;
+    std::atomic<std::thread::id> doneThread;
+    std::atomic<int> deferred{0};
+};
+
+static HttpHandler makeHandler(Probe* probe) {
+    return [probe](const HttpRequest& req, HttpResponse& resp) {
+        probe->loopThread = std::this_thread::get_id();
+        if(req.path == "/slow") {
+            // 请求字段在 handler 返回后失效，先拷贝
+            std::string path(req.path);
+            ++probe->deferred;
+            resp.defer([probe, path](HttpResponse& r) {
+                probe->workThread = std::this_thread::get_id();
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                r.setBody("deferred " + path);
+            }, [probe] {
+                probe->doneThread = std::this_thread::get_id();
+            });
+            return;
+        }
+        resp.setBody("inline " + std::string(req.path));
+    };
+}
+
+static int connectTo(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK(fd >= 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    struct timeval tv = {5, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    return fd;
+}
+
+// 发出请求后读到对端关闭
+static std::string roundTrip(int port, const std::string& req) {
+    int fd = connectTo(port);
+    CHECK(write(fd, req.data(), req.size()) == static_cast<ssize_t>(req.size()));
+    std::string out;
+    char buf[4096];
+    ssize_t n;
+    while((n = read(fd, buf, sizeof(buf))) > 0) {
+        out.append(buf, n);
+    }
+    close(fd);
+    return out;
+}
+
+// init() 与 loop() 在同一线程上调用，UringLoop 要求如此；init() 失败时返回 false
+template<class Loop>
+static bool testDeferred(Loop& loop, int port, Probe* probe) {
+    std::promise<bool> ready;
+    std::future<bool> inited = ready.get_future();
+    std::thread t([&loop, &ready] {
+        bool ok = loop.init();
+        ready.set_value(ok);
+        if(ok) {
+            loop.loop();
+        }
+    });
+    if(!inited.get()) {
+        t.join();
+        return false;
+    }
+
+    // 流水线上推迟的响应之后的请求，按顺序回复
+    std::string out = roundTrip(port,
+        "GET /slow HTTP/1.1\r\nHost: a\r\n\r\n"
+        "GET /fast HTTP/1.1\r\nHost: a\r\nConnection: close\r\n\r\n");
+    size_t slow = out.find("deferred /slow");
+    size_t fast = out.find("inline /fast");
+    CHECK(slow != std::string::npos);
+    CHECK(fast != std::string::npos);
+    CHECK(slow < fast);
+    CHECK(probe->deferred.load() == 1);
+    CHECK(probe->workThread.load() != probe->loopThread.load());
+    CHECK(probe->doneThread.load() == probe->loopThread.load());
+
+    // 推迟的响应带 Connection: close 时，发出后再关闭
+    out = roundTrip(port, "GET /slow HTTP/1.1\r\nHost: a\r\nConnection: close\r\n\r\n");
+    CHECK(out.find("HTTP/1.1 200") == 0);
+    CHECK(out.find("deferred /slow") != std::string::npos);
+    CHECK(probe->deferred.load() == 2);
+
+    // 工作还在线程池上时停止，循环等它回来再退出
+    int fd = connectTo(port);
+    const char* req = "GET /slow HTTP/1.1\r\nHost: a\r\n\r\n";
+    CHECK(write(fd, req, strlen(req)) == static_cast<ssize_t>(strlen(req)));
+    while(probe->deferred.load() != 3) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    loop.stop();
+    t.join();
+    close(fd);
+    return true;
+}
+
+int main() {
+    INS()->setLevel("error");
+    ThreadPool pool(2);
+    OverloadControl overload(OverloadControl::Config{});
+    int port = 20000 + getpid() % 20000;
+    {
+        Probe probe;
+        HttpHandler handler = makeHandler(&probe);
+        EventLoop loop(port, 64, &pool, &handler, &overload);
+        CHECK(testDeferred(loop, port, &probe));
+    }
+    {
+        // 内核不支持 io_uring 时跳过
+        Probe probe;
+        HttpHandler handler = makeHandler(&probe);
+        UringLoop loop(port + 1, 64, &pool, &handler, &overload);
+        testDeferred(loop, port + 1, &probe);
+    }
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include <string>
+#include "check.h"
+#include "Http/httpParser.h"
+
+static HttpParser::Result parseAll(HttpParser& parser, const std::string& data) {
+    parser.reset();
+    return parser.parse(data.data(), data.size());
+}
+
+static std::string chunkedHead(const std::string& te = "chunked") {
+    return "POST /upload HTTP/1.1\r\nHost: a\r\nTransfer-Encoding: " + te + "\r\n\r\n";
+}
+
+static void testChunked() {
+    HttpParser parser;
+    std::string req = chunkedHead() + "5;name=v\r\nhello\r\n6 \r\n world\r\n0\r\nX-Sum: 1\r\n\r\nGET";
+    CHECK(parseAll(parser, req) == HttpParser::COMPLETE);
+    CHECK(parser.request().body == "hello world");
+    CHECK(parser.consumed() == req.size() - 3);
+
+    // 逐字节喂入，结果应与一次喂入相同
+    std::string whole = req.substr(0, req.size() - 3);
+    parser.reset();
+    HttpParser::Result r = HttpParser::INCOMPLETE;
+    for(size_t n = 1; n <= whole.size(); ++n) {
+        r = parser.parse(whole.data(), n);
+        CHECK(r != HttpParser::ERROR);
+        CHECK(n == whole.size() || r == HttpParser::INCOMPLETE);
+    }
+    CHECK(r == HttpParser::COMPLETE && parser.request().body == "hello world");
+}
+
+static void testChunkSizeSyntax() {
+    HttpParser parser;
+    CHECK(parseAll(parser, chunkedHead() + "1 0\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead() + " 5\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead() + "5x\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead() + ";ext\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead() + "5\rx") == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead() + "5\t;ext\r\n") == HttpParser::INCOMPLETE);
+}
+
+static void testLimits() {
+    HttpParser parser;
+    // 没有行尾的超长 chunk-size 行和 trailer 都应在超过上限时报错，而不是一直等待
+    std::string longExt = chunkedHead() + "5;" + std::string(HttpParser::kMaxChunkLineBytes, 'a');
+    CHECK(parseAll(parser, longExt) == HttpParser::ERROR);
+    std::string trailer = chunkedHead() + "0\r\n";
+    while(trailer.size() < chunkedHead().size() + HttpParser::kMaxTrailerBytes) {
+        trailer += "X-Pad: aaaaaaaaaaaaaaaa\r\n";
+    }
+    CHECK(parseAll(parser, trailer) == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead() + "0\r\nX-Pad: " + std::string(HttpParser::kMaxTrailerBytes, 'a'))
+          == HttpParser::ERROR);
+}
+
+static void testTransferEncoding() {
+    HttpParser parser;
+    CHECK(parseAll(parser, chunkedHead("gzip, chunked") + "0\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(parseAll(parser, chunkedHead("CHUNKED") + "0\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(parseAll(parser, chunkedHead("gzip") + "0\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead("chunked, gzip") + "0\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, chunkedHead("chunked, chunked") + "0\r\n\r\n") == HttpParser::ERROR);
+    std::string twoHeaders = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: gzip\r\n\r\n0\r\n\r\n";
+    CHECK(parseAll(parser, twoHeaders) == HttpParser::ERROR);
+}
+
+static void testRequestLine() {
+    HttpParser parser;
+    std::string req = "GET /a/b?x=1&y=2 HTTP/1.1\r\nHost: h\r\nX-Empty:\r\nX-Pad: \t v \r\n\r\n";
+    CHECK(parseAll(parser, req) == HttpParser::COMPLETE);
+    const HttpRequest& r = parser.request();
+    CHECK(r.method == "GET");
+    CHECK(r.target == "/a/b?x=1&y=2");
+    CHECK(r.path == "/a/b");
+    CHECK(r.query == "x=1&y=2");
+    CHECK(r.versionMinor == 1);
+    CHECK(r.headers.size() == 3);
+    CHECK(r.header("host") == "h");
+    CHECK(r.header("X-EMPTY").empty());
+    CHECK(r.header("x-pad") == "v");
+    CHECK(r.header("missing").data() == nullptr);
+    CHECK(r.body.empty());
+    CHECK(parser.consumed() == req.size());
+
+    CHECK(parseAll(parser, "GET /?\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(parser.request().query.empty());
+    std::string emptyQuery = "GET /? HTTP/1.1\r\n\r\n";
+    CHECK(parseAll(parser, emptyQuery) == HttpParser::COMPLETE);
+    CHECK(parser.request().path == "/" && parser.request().query.empty());
+    CHECK(parseAll(parser, "GET  / HTTP/1.1\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, " / HTTP/1.1\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET / HTTP/2.0\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\nNoColon\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\n: v\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\nHost : a\r\n\r\n") == HttpParser::ERROR);
+}
+
+// 两次调用之间缓冲被搬移，之前解析出的 string_view 应指向新缓冲
+static void testRebase() {
+    HttpParser parser;
+    std::string req = "POST /up?k=v HTTP/1.1\r\nHost: a\r\nContent-Length: 5\r\n\r\nhello";
+    std::string first = req.substr(0, req.size() - 3);
+    CHECK(parseAll(parser, first) == HttpParser::INCOMPLETE);
+    std::string moved = req;
+    CHECK(parser.parse(moved.data(), moved.size()) == HttpParser::COMPLETE);
+    first.assign(first.size(), 'x');
+    const HttpRequest& r = parser.request();
+    const char* begin = moved.data();
+    const char* end = moved.data() + moved.size();
+    CHECK(r.method.data() >= begin && r.method.data() < end);
+    CHECK(r.header("host").data() >= begin && r.header("host").data() < end);
+    CHECK(r.method == "POST" && r.path == "/up" && r.query == "k=v");
+    CHECK(r.header("Host") == "a");
+    CHECK(r.body == "hello");
+    CHECK(parser.consumed() == req.size());
+
+    // 请求头还不完整时搬移，也从上次扫描的位置继续
+    std::string head = "GET /x HTTP/1.1\r\nHost: b\r\n\r\n";
+    parser.reset();
+    std::string part = "\r\n" + head.substr(0, 10);
+    CHECK(parser.parse(part.data(), part.size()) == HttpParser::INCOMPLETE);
+    std::string whole = "\r\n" + head;
+    CHECK(parser.parse(whole.data(), whole.size()) == HttpParser::COMPLETE);
+    CHECK(parser.request().path == "/x" && parser.request().header("host") == "b");
+    CHECK(parser.consumed() == whole.size());
+}
+
+static void testPipelined() {
+    HttpParser parser;
+    std::string buf = "GET /1 HTTP/1.1\r\n\r\n"
+                      "\r\n\r\nPOST /2 HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+                      "GET /3 HTTP/1.1\r\nConnection: close\r\n\r\n"
+                      "GET /4";
+    size_t off = 0;
+    const char* paths[] = {"/1", "/2", "/3"};
+    for(const char* path : paths) {
+        parser.reset();
+        CHECK(parser.parse(buf.data() + off, buf.size() - off) == HttpParser::COMPLETE);
+        CHECK(parser.request().path == path);
+        off += parser.consumed();
+    }
+    CHECK(parser.request().keepAlive == false);
+    CHECK(buf.substr(off) == "GET /4");
+    parser.reset();
+    CHECK(parser.parse(buf.data() + off, buf.size() - off) == HttpParser::INCOMPLETE);
+}
+
+static void testKeepAlive() {
+    HttpParser parser;
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(parser.request().keepAlive);
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\nConnection: Upgrade, Close\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(!parser.request().keepAlive);
+    CHECK(parseAll(parser, "GET / HTTP/1.0\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(parser.request().versionMinor == 0);
+    CHECK(!parser.request().keepAlive);
+    CHECK(parseAll(parser, "GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(parser.request().keepAlive);
+}
+
+static void testContentLength() {
+    HttpParser parser;
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nContent-Length: 3\r\n\r\nab") == HttpParser::INCOMPLETE);
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nContent-Length: 0\r\n\r\n") == HttpParser::COMPLETE);
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n\r\nabc")
+          == HttpParser::ERROR);
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nContent-Length: 3, 3\r\n\r\nabc") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nContent-Length:\r\n\r\n") == HttpParser::ERROR);
+    std::string tooLong = "POST / HTTP/1.1\r\nContent-Length: " + std::to_string(HttpParser::kMaxBodyBytes + 1) + "\r\n\r\n";
+    CHECK(parseAll(parser, tooLong) == HttpParser::ERROR);
+    // Content-Length 与 chunked 同时出现
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n")
+          == HttpParser::ERROR);
+    CHECK(parseAll(parser, "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\n0\r\n\r\n")
+          == HttpParser::ERROR);
+}
+
+// 孤立的 \r 不能被当作行尾，否则后面的请求头会被丢掉
+static void testBareCr() {
+    HttpParser parser;
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\nX: a\rb\r\nHost: z\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET / HTTP/1.1\r\nX: a\r\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET /\rx HTTP/1.1\r\n\r\n") == HttpParser::ERROR);
+    CHECK(parseAll(parser, "GET / HTTP/1.1\rHost: z\r\n\r\n") == HttpParser::ERROR);
+}
+
+// 请求行之前的空行计入请求头长度上限
+static void testLeadingCrlf() {
+    HttpParser parser;
+    std::string req = "\r\n\r\nGET / HTTP/1.1\r\n\r\n";
+    CHECK(parseAll(parser, req) == HttpParser::COMPLETE);
+    CHECK(parser.consumed() == req.size());
+
+    std::string blank;
+    while(blank.size() <= HttpParser::kMaxHeaderBytes) {
+        blank += "\r\n";
+    }
+    CHECK(parseAll(parser, blank) == HttpParser::ERROR);
+
+    // 逐段喂入的空行也累计
+    parser.reset();
+    HttpParser::Result r = HttpParser::INCOMPLETE;
+    for(size_t n = 2; n <= blank.size() && r == HttpParser::INCOMPLETE; n += 2) {
+        r = parser.parse(blank.data(), n);
+    }
+    CHECK(r == HttpParser::ERROR);
+
+    std::string padded(HttpParser::kMaxHeaderBytes - 20, '\n');
+    for(size_t i = 0; i < padded.size(); i += 2) {
+        padded[i] = '\r';
+    }
+    CHECK(parseAll(parser, padded + "GET / HTTP/1.1\r\nHost: a\r\n\r\n") == HttpParser::ERROR);
+}
+
+int main() {
+    testChunked();
+    testChunkSizeSyntax();
+    testLimits();
+    testTransferEncoding();
+    testRequestLine();
+    testRebase();
+    testPipelined();
+    testKeepAlive();
+    testContentLength();
+    testBareCr();
+    testLeadingCrlf();
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include <stdint.h>
+#include <vector>
+#include "check.h"
+#include "MemoryPool/ConcurrentAlloc.hpp"
+
+// 大小类对齐到 16 字节，且 roundUp 与 index 一一对应、下标不越界
+static void testSizeClass() {
+    size_t lastSize = 0, lastIndex = 0;
+    for(size_t size = 1; size <= MAXBYTES; ++size) {
+        size_t rounded = SizeClass::roundUp(size);
+        size_t idx = SizeClass::index(rounded);
+        CHECK(rounded >= size && rounded % 16 == 0);
+        CHECK(idx < NLISTS);
+        CHECK(SizeClass::index(size) == idx);
+        if(rounded != lastSize) {
+            CHECK(lastSize == 0 || idx == lastIndex + 1);
+            lastSize = rounded;
+            lastIndex = idx;
+        }
+    }
+    CHECK(lastIndex == NLISTS - 1);
+}
+
+// 池中取出的内存满足 operator new 的默认对齐
+static void testAlignment() {
+    std::vector<std::pair<void*, size_t>> ptrs;
+    for(size_t size = 1; size <= 4096; size += 7) {
+        void* p = ConcurrentAlloc(size);
+        CHECK(reinterpret_cast<uintptr_t>(p) % __STDCPP_DEFAULT_NEW_ALIGNMENT__ == 0);
+        ptrs.emplace_back(p, size);
+    }
+    for(auto& p : ptrs) {
+        ConcurrentFree(p.first, p.second);
+    }
+}
+
+int main() {
+    INS()->setLevel("error");
+    testSizeClass();
+    testAlignment();
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+#include "check.h"
+#include "Net/overload.h"
+
+using namespace std::chrono;
+
+// 记录写出的每条日志，检查开始和停止拒绝时各写一条 WARN
+class CaptureAppender : public Lwy::Appender {
+public:
+    void output(const Lwy::LogMsg::ptr& msg, std::ostream&) override {
+        std::lock_guard<std::mutex> lck(mtx_);
+        msgs_.push_back(msg->getMsg());
+    }
+
+    std::vector<std::string> take() {
+        std::lock_guard<std::mutex> lck(mtx_);
+        std::vector<std::string> msgs;
+        msgs.swap(msgs_);
+        return msgs;
+    }
+
+private:
+    std::mutex mtx_;
+    std::vector<std::string> msgs_;
+};
+
+static OverloadControl::Config makeConfig(int idleMs, int requestMs, int queueDelayMs) {
+    OverloadControl::Config config;
+    config.idleTimeoutMs = idleMs;
+    config.requestTimeoutMs = requestMs;
+    config.queueDelayMs = queueDelayMs;
+    return config;
+}
+
+static void testShouldShed(CaptureAppender& log) {
+    OverloadControl overload(makeConfig(0, 0, 100));
+    log.take();
+    CHECK(!overload.shouldShed(milliseconds(50)));
+    CHECK(!overload.shouldShed(milliseconds(100)));
+    CHECK(log.take().empty());
+    CHECK(overload.stats().shedConns == 0);
+
+    // 超过目标开始拒绝，只在切换时写一条
+    CHECK(overload.shouldShed(milliseconds(101)));
+    CHECK(overload.shouldShed(milliseconds(500)));
+    std::vector<std::string> msgs = log.take();
+    CHECK(msgs.size() == 1);
+    CHECK(msgs[0].find("exceeds 100ms") != std::string::npos);
+    CHECK(overload.stats().shedConns == 2);
+
+    // 回落后恢复接入，同样只写一条
+    CHECK(!overload.shouldShed(milliseconds(20)));
+    CHECK(!overload.shouldShed(microseconds(0)));
+    msgs = log.take();
+    CHECK(msgs.size() == 1);
+    CHECK(msgs[0].find("back to 20000us") != std::string::npos);
+    CHECK(overload.stats().shedConns == 2);
+
+    // queueDelayMs 为 0 关闭接入控制
+    OverloadControl off(makeConfig(0, 0, 0));
+    CHECK(!off.shouldShed(seconds(10)));
+    CHECK(log.take().empty());
+    CHECK(off.stats().shedConns == 0);
+
+    // 单 Reactor 模式按线程池队首任务的等待时间判断，空队列不拒绝
+    ThreadPool pool(1);
+    CHECK(!overload.shouldShed(pool));
+}
+
+static void testConnectionLimit() {
+    OverloadControl::Config config = makeConfig(0, 0, 0);
+    config.maxConnections = 2;
+    OverloadControl overload(config);
+    CHECK(overload.acquireConnection());
+    CHECK(overload.acquireConnection());
+    CHECK(!overload.acquireConnection());
+    CHECK(overload.stats().connections == 2 && overload.stats().rejectedConns == 1);
+    overload.releaseConnection();
+    CHECK(overload.acquireConnection());
+}
+
+// 每个连接一个定时器，到期时按连接当前状态重新计算下次检查时间
+static void testCheckTimeout() {
+    struct sockaddr_in addr = {};
+    const int64_t t0 = 1000000;
+
+    CHECK(OverloadControl(makeConfig(1000, 300, 0)).firstCheckMs() == 300);
+    CHECK(OverloadControl(makeConfig(200, 300, 0)).firstCheckMs() == 200);
+    CHECK(OverloadControl(makeConfig(1000, 0, 0)).firstCheckMs() == 1000);
+    CHECK(OverloadControl(makeConfig(0, 300, 0)).firstCheckMs() == 300);
+    CHECK(OverloadControl(makeConfig(0, 0, 0)).firstCheckMs() == -1);
+
+    {
+        // 空闲连接：间隔不超过请求超时，空闲满 idleTimeoutMs 后关闭
+        OverloadControl overload(makeConfig(1000, 300, 0));
+        Connection conn(-1, addr, 1, nullptr);
+        conn.touch(t0);
+        CHECK(conn.requestStart() == 0);
+        CHECK(overload.checkTimeout(conn, t0 + 100) == 300);
+        CHECK(overload.checkTimeout(conn, t0 + 800) == 200);
+        // 期间有读写，从最后活跃时间重新计算
+        conn.touch(t0 + 900);
+        CHECK(overload.checkTimeout(conn, t0 + 1000) == 300);
+        CHECK(overload.checkTimeout(conn, t0 + 1899) == 1);
+        CHECK(overload.stats().idleTimeouts == 0);
+        CHECK(overload.checkTimeout(conn, t0 + 1900) == 0);
+        CHECK(overload.stats().idleTimeouts == 1);
+    }
+    {
+        // 收到请求首字节后按请求超时计算，不受之后读写的影响
+        OverloadControl overload(makeConfig(1000, 300, 0));
+        Connection conn(-1, addr, 1, nullptr);
+        conn.appendInput("GET / HT", 8);
+        conn.touch(t0);
+        CHECK(conn.requestStart() == t0);
+        CHECK(overload.checkTimeout(conn, t0 + 100) == 200);
+        conn.appendInput("TP/1.1\r\n", 8);
+        conn.touch(t0 + 250);
+        CHECK(conn.requestStart() == t0);
+        CHECK(overload.checkTimeout(conn, t0 + 250) == 50);
+        CHECK(overload.checkTimeout(conn, t0 + 300) == 0);
+        CHECK(overload.stats().requestTimeouts == 1 && overload.stats().idleTimeouts == 0);
+    }
+    {
+        // 请求处理完后回到空闲检查
+        OverloadControl overload(makeConfig(1000, 300, 0));
+        Connection conn(-1, addr, 1, nullptr);
+        conn.appendInput("GET / HTTP/1.1\r\n\r\n", 18);
+        conn.touch(t0);
+        CHECK(conn.requestStart() == t0);
+        conn.process();
+        conn.retrieveOutput(conn.toWriteBytes());
+        conn.touch(t0 + 100);
+        CHECK(conn.requestStart() == 0);
+        CHECK(overload.checkTimeout(conn, t0 + 400) == 300);
+        CHECK(overload.checkTimeout(conn, t0 + 1000) == 100);
+        CHECK(overload.stats().requestTimeouts == 0);
+    }
+    {
+        // 只检查请求超时：空闲连接按请求超时周期重新挂上
+        OverloadControl overload(makeConfig(0, 300, 0));
+        Connection conn(-1, addr, 1, nullptr);
+        conn.touch(t0);
+        CHECK(overload.checkTimeout(conn, t0 + 300) == 300);
+        CHECK(overload.checkTimeout(conn, t0 + 100000) == 300);
+        CHECK(overload.stats().idleTimeouts == 0);
+    }
+    {
+        // 只检查空闲超时：进行中的请求也按最后活跃时间计算
+        OverloadControl overload(makeConfig(1000, 0, 0));
+        Connection conn(-1, addr, 1, nullptr);
+        conn.appendInput("GET", 3);
+        conn.touch(t0);
+        CHECK(overload.checkTimeout(conn, t0 + 400) == 600);
+        CHECK(overload.checkTimeout(conn, t0 + 1000) == 0);
+        CHECK(overload.stats().idleTimeouts == 1 && overload.stats().requestTimeouts == 0);
+    }
+    {
+        // 都关闭时不再检查
+        OverloadControl overload(makeConfig(0, 0, 0));
+        Connection conn(-1, addr, 1, nullptr);
+        CHECK(overload.checkTimeout(conn, t0) == -1);
+    }
+}
+
+int main() {
+    std::shared_ptr<CaptureAppender> log = std::make_shared<CaptureAppender>();
+    INS() = std::make_shared<Lwy::Logger>("test", Lwy::LogLevel::WARN, log, "%e");
+    testShouldShed(*log);
+    testConnectionLimit();
+    testCheckTimeout();
+    return 0;
+}
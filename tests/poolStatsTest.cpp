@@ -0,0 +1,78 @@
+#include <cmath>
+#include <cstdint>
+#include "check.h"
+#include "Pool/poolStats.hpp"
+
+typedef LatencyHistogram H;
+
+// 小于 SUB_COUNT 的值各占一个桶；之后每个 2 的幂区间 16 个等宽子桶，下标随值单调、连续增长
+static void testBucketBoundaries() {
+    for(uint64_t v = 0; v < H::SUB_COUNT; ++v) {
+        CHECK(H::bucketOf(v) == v);
+        CHECK(H::bucketMid(v) == v);
+    }
+    CHECK(H::bucketOf(16) == 16 && H::bucketOf(31) == 31);
+    CHECK(H::bucketOf(32) == 32 && H::bucketOf(33) == 32 && H::bucketOf(34) == 33);
+    CHECK(H::bucketOf(64) == 48 && H::bucketOf(67) == 48 && H::bucketOf(68) == 49);
+
+    size_t last = 0;
+    for(uint64_t v = 1; v < (1ULL << 20); ++v) {
+        size_t idx = H::bucketOf(v);
+        CHECK(idx == last || idx == last + 1);
+        last = idx;
+    }
+    // 上限附近与超出范围的值落在最后一个桶
+    CHECK(H::bucketOf((1ULL << (H::MAX_EXP + 1)) - 1) == H::BUCKETS - 1);
+    CHECK(H::bucketOf(1ULL << (H::MAX_EXP + 1)) == H::BUCKETS - 1);
+    CHECK(H::bucketOf(UINT64_MAX) == H::BUCKETS - 1);
+}
+
+// 桶中值与原值的相对误差不超过 1/16（约 6%）
+static void testRelativeError() {
+    for(int exp = 4; exp <= H::MAX_EXP; ++exp) {
+        uint64_t base = 1ULL << exp;
+        for(uint64_t step = 0; step < 64; ++step) {
+            uint64_t v = base + step * (base / 64);
+            double mid = static_cast<double>(H::bucketMid(H::bucketOf(v)));
+            CHECK(std::fabs(mid - v) / v <= 1.0 / 16);
+        }
+    }
+}
+
+static bool near(uint64_t got, double want) {
+    return std::fabs(got - want) / want <= 1.0 / 16;
+}
+
+static void testPercentiles() {
+    H::Snapshot empty;
+    CHECK(empty.percentile(0.5) == 0 && empty.mean() == 0);
+
+    H hist;
+    for(uint64_t v = 1; v <= 10000; ++v) {
+        hist.record(v * 1000);
+    }
+    H::Snapshot s;
+    hist.snapshot(s);
+    CHECK(s.count == 10000);
+    CHECK(s.max == 10000000);
+    CHECK(s.mean() == 5000500);
+    CHECK(near(s.percentile(0.5), 5000000));
+    CHECK(near(s.percentile(0.9), 9000000));
+    CHECK(near(s.percentile(0.99), 9900000));
+    CHECK(s.percentile(1.0) <= s.max);
+    CHECK(near(s.percentile(0.0), 1000));
+
+    // 合并后分布不变，计数翻倍
+    H::Snapshot merged;
+    merged.merge(s);
+    merged.merge(s);
+    CHECK(merged.count == 20000 && merged.max == s.max);
+    CHECK(merged.percentile(0.5) == s.percentile(0.5));
+}
+
+int main() {
+    testBucketBoundaries();
+    testRelativeError();
+    testPercentiles();
+    return 0;
+}
@@ -0,0 +1,337 @@
+#include <ftw.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <functional>
+#include "check.h"
+#include "Log/log.h"
+#include "Http/staticFile.h"
+
+static std::string g_dir;
+
+static void writeFile(const std::string& name, const std::string& content) {
+    std::string path = g_dir + "/" + name;
+    FILE* f = fopen(path.c_str(), "w");
+    CHECK(f != nullptr);
+    CHECK(fwrite(content.data(), 1, content.size(), f) == content.size());
+    fclose(f);
+}
+
+static void setMtime(const std::string& name, time_t sec) {
+    struct timespec ts[2];
+    ts[0].tv_sec = ts[1].tv_sec = sec;
+    ts[0].tv_nsec = ts[1].tv_nsec = 0;
+    CHECK(utimensat(AT_FDCWD, (g_dir + "/" + name).c_str(), ts, 0) == 0);
+}
+
+static StaticFileHandler::Config makeConfig() {
+    StaticFileHandler::Config config;
+    config.root = g_dir + "/www/";
+    config.prefix = "/static/";
+    return config;
+}
+
+// 像连接那样调用处理器：先按请求设置 keep-alive
+static bool serve(StaticFileHandler& handler, HttpResponse& resp, std::string_view path,
+                  std::string_view method = "GET", bool keepAlive = true) {
+    HttpRequest req;
+    req.method = method;
+    req.target = path;
+    req.path = path;
+    req.keepAlive = keepAlive;
+    resp.reset();
+    resp.setKeepAlive(keepAlive);
+    return handler.serve(req, resp);
+}
+
+// 按连接发出的内容序列化响应
+static std::string render(HttpResponse& resp, bool head = false) {
+    std::string out;
+    if(resp.raw()) {
+        return *resp.raw();
+    }
+    if(resp.sharedBody()) {
+        const std::string& buf = *resp.sharedBody();
+        resp.appendHead(out, buf.size() - resp.sharedOffset());
+        if(!head) {
+            out.append(buf, resp.sharedOffset(), std::string::npos);
+        }
+        return out;
+    }
+    if(resp.hasFile()) {
+        resp.appendHead(out, resp.fileLength());
+        off_t offset;
+        size_t len;
+        int fd = resp.takeFile(&offset, &len);
+        std::string body(len, '\0');
+        CHECK(pread(fd, &body[0], len, offset) == static_cast<ssize_t>(len));
+        close(fd);
+        if(!head) {
+            out += body;
+        }
+        return out;
+    }
+    resp.appendHead(out, resp.body().size());
+    if(!head) {
+        out += resp.body();
+    }
+    return out;
+}
+
+static std::string bodyOf(const std::string& out) {
+    size_t pos = out.find("\r\n\r\n");
+    CHECK(pos != std::string::npos);
+    return out.substr(pos + 4);
+}
+
+static void testResolve() {
+    StaticFileHandler handler(makeConfig());
+    HttpResponse resp;
+    CHECK(!serve(handler, resp, "/other/a.txt"));
+
+    const char* bad[] = {
+        "/static/../secret.txt",
+        "/static/%2e%2e/secret.txt",
+        "/static/%2E%2e/secret.txt",
+        "/static/sub/../../secret.txt",
+        "/static/sub/%2e%2e/%2e%2e/secret.txt",
+        "/static/..",
+        "/static/a.txt%00.html",
+        "/static/%zz",
+        "/static/%2",
+    };
+    for(const char* path : bad) {
+        CHECK(serve(handler, resp, path));
+        CHECK(resp.getStatus() == 404);
+        CHECK(!resp.raw() && !resp.sharedBody() && !resp.hasFile());
+    }
+    CHECK(handler.stats().notFound == sizeof(bad) / sizeof(bad[0]));
+
+    // 文件名中带点的路径段不是 ..，编码的普通字符正常解码
+    CHECK(serve(handler, resp, "/static/..a.txt"));
+    CHECK(resp.getStatus() == 200 && bodyOf(render(resp)) == "dots");
+    CHECK(serve(handler, resp, "/static/%61.txt"));
+    CHECK(bodyOf(render(resp)) == "aaa");
+
+    CHECK(serve(handler, resp, "/static/a.txt", "POST"));
+    CHECK(resp.getStatus() == 405);
+}
+
+static void testIndex() {
+    StaticFileHandler handler(makeConfig());
+    HttpResponse resp;
+    CHECK(serve(handler, resp, "/static/"));
+    std::string out = render(resp);
+    CHECK(bodyOf(out) == "root index");
+    CHECK(out.find("Content-Type: text/html; charset=utf-8\r\n") != std::string::npos);
+    CHECK(serve(handler, resp, "/static/sub/"));
+    CHECK(bodyOf(render(resp)) == "sub index");
+    CHECK(serve(handler, resp, "/static/sub"));
+    CHECK(resp.getStatus() == 404);
+}
+
+// Connection: close 与 HEAD 重新生成响应头，响应体引用缓存中的同一份数据
+static void testCloseAndHead() {
+    StaticFileHandler handler(makeConfig());
+    HttpResponse resp;
+    CHECK(serve(handler, resp, "/static/a.txt"));
+    std::shared_ptr<const std::string> raw = resp.raw();
+    CHECK(raw && raw->find("Connection: keep-alive\r\n") != std::string::npos);
+
+    CHECK(serve(handler, resp, "/static/a.txt", "GET", false));
+    CHECK(!resp.raw() && resp.sharedBody() == raw);
+    std::string out = render(resp);
+    CHECK(out.find("Connection: close\r\n") != std::string::npos);
+    CHECK(out.find("Content-Length: 3\r\n") != std::string::npos);
+    CHECK(bodyOf(out) == "aaa");
+
+    CHECK(serve(handler, resp, "/static/a.txt", "HEAD"));
+    CHECK(!resp.raw() && resp.sharedBody() == raw);
+    out = render(resp, true);
+    CHECK(out.find("Connection: keep-alive\r\n") != std::string::npos);
+    CHECK(out.find("Content-Length: 3\r\n") != std::string::npos);
+    CHECK(bodyOf(out).empty());
+    CHECK(handler.stats().hits == 2 && handler.stats().misses == 1);
+}
+
+// 按路径哈希分片，容量平均分到每片；与 StaticFileHandler::kShards 一致
+static const size_t kShards = 16;
+
+static size_t shardOf(const std::string& name) {
+    return std::hash<std::string>()(g_dir + "/www/" + name) % kShards;
+}
+
+static void testEviction() {
+    // 内容和文件名长度相同的文件，缓存项大小也相同
+    for(int i = 0; i < 40; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "www/f%02d.txt", i);
+        writeFile(name, std::string(100, static_cast<char>('a' + i % 26)));
+    }
+    size_t entryBytes;
+    {
+        StaticFileHandler handler(makeConfig());
+        HttpResponse resp;
+        CHECK(serve(handler, resp, "/static/f00.txt"));
+        entryBytes = handler.stats().cachedBytes;
+        CHECK(entryBytes > 100);
+    }
+
+    // 每片只放得下一项：总数不超过分片数，多出的都被淘汰
+    StaticFileHandler::Config config = makeConfig();
+    config.capacity = kShards * (entryBytes + entryBytes / 2);
+    {
+        StaticFileHandler handler(config);
+        HttpResponse resp;
+        char path[32];
+        for(int i = 0; i < 40; ++i) {
+            snprintf(path, sizeof(path), "/static/f%02d.txt", i);
+            CHECK(serve(handler, resp, path));
+            CHECK(bodyOf(render(resp)) == std::string(100, static_cast<char>('a' + i % 26)));
+        }
+        StaticFileHandler::Stats s = handler.stats();
+        CHECK(s.misses == 40);
+        CHECK(s.cachedFiles <= kShards);
+        CHECK(s.evictions == 40 - s.cachedFiles);
+        CHECK(s.cachedBytes == s.cachedFiles * entryBytes);
+        CHECK(s.cachedBytes <= config.capacity);
+        // 最后读入的一项仍在缓存中
+        CHECK(serve(handler, resp, "/static/f39.txt"));
+        CHECK(handler.stats().hits == 1);
+    }
+
+    // 每片放得下两项：同一片中最久未用的先被淘汰
+    std::vector<std::string> byShard[kShards];
+    std::vector<std::string>* same = nullptr;
+    for(int i = 0; same == nullptr; ++i) {
+        char name[32];
+        snprintf(name, sizeof(name), "s%03d.txt", i);
+        std::vector<std::string>& names = byShard[shardOf(name)];
+        names.push_back(name);
+        if(names.size() == 3) {
+            same = &names;
+        }
+    }
+    for(const std::string& name : *same) {
+        writeFile("www/" + name, std::string(100, 'x'));
+    }
+    config.capacity = kShards * (2 * entryBytes + entryBytes / 2);
+    {
+        StaticFileHandler handler(config);
+        HttpResponse resp;
+        CHECK(serve(handler, resp, "/static/" + (*same)[0]));
+        CHECK(serve(handler, resp, "/static/" + (*same)[1]));
+        CHECK(serve(handler, resp, "/static/" + (*same)[0]));
+        CHECK(serve(handler, resp, "/static/" + (*same)[2]));
+        CHECK(handler.stats().evictions == 1);
+        CHECK(serve(handler, resp, "/static/" + (*same)[0]));
+        CHECK(handler.stats().hits == 2);
+        CHECK(serve(handler, resp, "/static/" + (*same)[1]));
+        CHECK(handler.stats().misses == 4);
+    }
+
+    // 大于单片容量的文件照常返回，但不进缓存
+    config.capacity = kShards * 50;
+    {
+        StaticFileHandler handler(config);
+        HttpResponse resp;
+        CHECK(serve(handler, resp, "/static/f00.txt"));
+        CHECK(bodyOf(render(resp)) == std::string(100, 'a'));
+        CHECK(handler.stats().cachedFiles == 0);
+        CHECK(handler.stats().evictions == 0);
+    }
+}
+
+static void testRevalidate() {
+    writeFile("www/r.txt", "old");
+    setMtime("www/r.txt", 1000000);
+    StaticFileHandler::Config config = makeConfig();
+    config.revalidateMs = 60000;
+    StaticFileHandler lazy(config);
+    config.revalidateMs = 0;
+    StaticFileHandler eager(config);
+    HttpResponse resp;
+    CHECK(serve(lazy, resp, "/static/r.txt") && bodyOf(render(resp)) == "old");
+    CHECK(serve(eager, resp, "/static/r.txt") && bodyOf(render(resp)) == "old");
+    CHECK(serve(eager, resp, "/static/r.txt") && eager.stats().hits == 1);
+
+    // 大小变化
+    writeFile("www/r.txt", "newer");
+    setMtime("www/r.txt", 1000000);
+    CHECK(serve(eager, resp, "/static/r.txt") && bodyOf(render(resp)) == "newer");
+    CHECK(eager.stats().invalidations == 1);
+
+    // 大小不变，只有修改时间变化
+    writeFile("www/r.txt", "NEWER");
+    setMtime("www/r.txt", 1000000);
+    CHECK(serve(eager, resp, "/static/r.txt") && bodyOf(render(resp)) == "newer");
+    setMtime("www/r.txt", 2000000);
+    CHECK(serve(eager, resp, "/static/r.txt") && bodyOf(render(resp)) == "NEWER");
+    CHECK(eager.stats().invalidations == 2);
+
+    // 检查间隔内不 stat，继续返回旧内容
+    CHECK(serve(lazy, resp, "/static/r.txt") && bodyOf(render(resp)) == "old");
+    CHECK(lazy.stats().invalidations == 0 && lazy.stats().hits == 1);
+
+    // 文件被删除
+    CHECK(unlink((g_dir + "/www/r.txt").c_str()) == 0);
+    CHECK(serve(eager, resp, "/static/r.txt") && resp.getStatus() == 404);
+}
+
+// 超过 maxFileSize 的文件不读入内存，交给连接 sendfile
+static void testSendfileThreshold() {
+    StaticFileHandler::Config config = makeConfig();
+    config.maxFileSize = 100;
+    writeFile("www/small.bin", std::string(100, 's'));
+    writeFile("www/big.bin", std::string(101, 'b'));
+    StaticFileHandler handler(config);
+    HttpResponse resp;
+    CHECK(serve(handler, resp, "/static/small.bin"));
+    CHECK(resp.raw() && !resp.hasFile());
+    CHECK(serve(handler, resp, "/static/big.bin"));
+    CHECK(!resp.raw() && resp.hasFile() && resp.fileLength() == 101);
+    std::string out = render(resp);
+    CHECK(out.find("Content-Type: application/octet-stream\r\n") != std::string::npos);
+    CHECK(out.find("Last-Modified: ") != std::string::npos);
+    CHECK(bodyOf(out) == std::string(101, 'b'));
+    StaticFileHandler::Stats s = handler.stats();
+    CHECK(s.sendfiles == 1 && s.cachedFiles == 1 && s.misses == 1);
+
+    // 容量为 0 时所有文件都走 sendfile
+    config.capacity = 0;
+    StaticFileHandler uncached(config);
+    CHECK(serve(uncached, resp, "/static/small.bin"));
+    CHECK(resp.hasFile() && uncached.stats().sendfiles == 1);
+}
+
+static int removeEntry(const char* path, const struct stat*, int, struct FTW*) {
+    return remove(path);
+}
+
+int main() {
+    INS()->setLevel("error");
+    char dir[] = "/tmp/staticFileTest.XXXXXX";
+    CHECK(mkdtemp(dir) != nullptr);
+    g_dir = dir;
+    CHECK(mkdir((g_dir + "/www").c_str(), 0755) == 0);
+    CHECK(mkdir((g_dir + "/www/sub").c_str(), 0755) == 0);
+    writeFile("secret.txt", "secret");
+    writeFile("www/a.txt", "aaa");
+    writeFile("www/..a.txt", "dots");
+    writeFile("www/index.html", "root index");
+    writeFile("www/sub/index.html", "sub index");
+
+    testResolve();
+    testIndex();
+    testCloseAndHead();
+    testEviction();
+    testRevalidate();
+    testSendfileThreshold();
+
+    nftw(dir, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+    return 0;
+}
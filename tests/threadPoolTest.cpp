@@ -0,0 +1,58 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "check.h"
+#include "Pool/threadPool.hpp"
+
+using namespace std::chrono;
+
+// 轮询 pred，最多等 timeout
+template<class Pred>
+static bool waitFor(Pred pred, milliseconds timeout) {
+    auto deadline = steady_clock::now() + timeout;
+    while(!pred()) {
+        if(steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return true;
+}
+
+// 唯一的线程被长任务占住时，排队的任务应在 spawnWait 之后由新线程执行
+static void testGrowWhenWorkersBlocked() {
+    ThreadPool::Config config;
+    config.minThreads = 1;
+    config.maxThreads = 4;
+    config.spawnWait = milliseconds(5);
+    ThreadPool pool(config);
+    std::atomic<bool> started{false};
+    std::atomic<bool> ran{false};
+    pool.addTask([&] {
+        started = true;
+        std::this_thread::sleep_for(milliseconds(500));
+    });
+    CHECK(waitFor([&] { return started.load(); }, milliseconds(1000)));
+    pool.addTask([&] { ran = true; });
+    CHECK(waitFor([&] { return ran.load(); }, milliseconds(100)));
+    CHECK(pool.threadCount() >= 2);
+}
+
+// 固定大小的线程池不扩容，任务全部执行
+static void testFixedPoolRunsAll() {
+    ThreadPool pool(2);
+    std::atomic<int> done{0};
+    for(int i = 0; i < 1000; ++i) {
+        pool.addTask([&] { done.fetch_add(1); });
+    }
+    CHECK(waitFor([&] { return done.load() == 1000; }, milliseconds(2000)));
+    CHECK(pool.threadCount() == 2);
+    CHECK(pool.queueDelay() == ThreadPool::Clock::duration::zero());
+}
+
+int main() {
+    INS()->setLevel("error");
+    testGrowWhenWorkersBlocked();
+    testFixedPoolRunsAll();
+    return 0;
+}
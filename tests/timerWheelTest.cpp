@@ -0,0 +1,60 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "check.h"
+#include "Pool/timerWheel.hpp"
+
+using namespace std::chrono;
+
+// 像事件循环那样用 nextTimeoutMs() 作为等待时间驱动时间轮：
+// 每次等待都在 [0, tick] 内，回调在 delay 之后、至多晚一个 tick 加少量调度误差触发，且不会空转
+static void testNextTimeoutDrivesWheel() {
+    const milliseconds tick(100);
+    TimerWheel wheel(nullptr, tick);
+    CHECK(wheel.nextTimeoutMs() == -1);
+    // 先空闲一段时间，让 now_ 落后于当前时间
+    std::this_thread::sleep_for(milliseconds(250));
+
+    std::atomic<bool> fired{false};
+    auto start = steady_clock::now();
+    steady_clock::time_point firedAt;
+    wheel.schedule(milliseconds(1000), [&] {
+        firedAt = steady_clock::now();
+        fired = true;
+    });
+    int rounds = 0;
+    while(!fired && steady_clock::now() - start < seconds(3)) {
+        int wait = wheel.nextTimeoutMs();
+        CHECK(wait >= 0 && wait <= tick.count());
+        std::this_thread::sleep_for(milliseconds(wait));
+        wheel.advance();
+        ++rounds;
+    }
+    CHECK(fired);
+    auto elapsed = duration_cast<milliseconds>(firedAt - start);
+    CHECK(elapsed >= milliseconds(1000));
+    CHECK(elapsed <= milliseconds(1000) + tick + milliseconds(50));
+    // 约 10 个 tick，加上追赶落后的一次和取整误差
+    CHECK(rounds <= 20);
+    CHECK(wheel.nextTimeoutMs() == -1);
+}
+
+// 取消后不触发
+static void testCancel() {
+    TimerWheel wheel;
+    std::atomic<bool> fired{false};
+    TimerWheel::TimerId id = wheel.schedule(milliseconds(5), [&] { fired = true; });
+    CHECK(wheel.cancel(id));
+    CHECK(!wheel.cancel(id));
+    std::this_thread::sleep_for(milliseconds(10));
+    wheel.advance();
+    CHECK(!fired);
+    CHECK(wheel.size() == 0);
+}
+
+int main() {
+    INS()->setLevel("error");
+    testNextTimeoutDrivesWheel();
+    testCancel();
+    return 0;
+}